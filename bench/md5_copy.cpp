@@ -0,0 +1,79 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+// Compares copying a buffer with memcpy and then ingesting the copy against md5_copy, which copies and ingests in one pass.
+//
+// Build from this directory with:
+//     g++ -std=c++11 -O2 -I.. md5_copy.cpp ../md5.cpp -o md5_copy
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "md5.h"
+
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef std::chrono::steady_clock clock_type;
+
+static constexpr u64 MESSAGE_BYTESIZE = 256 << 20; // The number of bytes copied and ingested per run. Much larger than the caches, so that the source is fetched from memory.
+static constexpr u32 RUN_COUNT        = 5;         // The number of times each method is timed.
+
+/// Returns the number of milliseconds since a point in time.
+///
+/// @param start the point in time.
+///
+/// @returns the number of milliseconds.
+static double elapsed_ms(clock_type::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+int main( void )
+{
+	std::vector<char> src(MESSAGE_BYTESIZE);
+	std::vector<char> dst_separate(MESSAGE_BYTESIZE);
+	std::vector<char> dst_fused(MESSAGE_BYTESIZE);
+	for (u64 i = 0; i < MESSAGE_BYTESIZE; ++i) {
+		src[i] = char(i * 131 + i / 977);
+	}
+	// Touch the destinations so that page faults are not timed.
+	memset(dst_separate.data(), 0, dst_separate.size());
+	memset(dst_fused.data(), 0, dst_fused.size());
+
+	double best_separate = 0.0;
+	double best_fused = 0.0;
+	for (u32 run = 0; run < RUN_COUNT; ++run) {
+		clock_type::time_point start = clock_type::now();
+		md5 separate;
+		memcpy(dst_separate.data(), src.data(), MESSAGE_BYTESIZE);
+		separate.ingest(dst_separate.data(), MESSAGE_BYTESIZE);
+		const md5::sum separate_sum = separate.digest();
+		const double separate_ms = elapsed_ms(start);
+
+		start = clock_type::now();
+		md5 fused;
+		md5_copy(dst_fused.data(), src.data(), MESSAGE_BYTESIZE, fused);
+		const md5::sum fused_sum = fused.digest();
+		const double fused_ms = elapsed_ms(start);
+
+		if (!(separate_sum == fused_sum) || memcmp(dst_separate.data(), dst_fused.data(), MESSAGE_BYTESIZE) != 0) {
+			printf("md5_copy does not match memcpy and ingest\n");
+			return 1;
+		}
+		best_separate = (run == 0 || separate_ms < best_separate) ? separate_ms : best_separate;
+		best_fused = (run == 0 || fused_ms < best_fused) ? fused_ms : best_fused;
+	}
+
+	const double mib = double(MESSAGE_BYTESIZE) / double(1 << 20);
+	printf("memcpy + ingest: %.1f ms (%.0f MiB/s)\n", best_separate, mib * 1000.0 / best_separate);
+	printf("md5_copy:        %.1f ms (%.0f MiB/s)\n", best_fused, mib * 1000.0 / best_fused);
+	return 0;
+}
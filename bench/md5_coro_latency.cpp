@@ -0,0 +1,172 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+// Measures how late a 1 ms ticker running on an event loop is while large buffers are digested, once with md5_ingest_async and once by blocking the loop with md5::ingest.
+//
+// Build from this directory with:
+//     g++ -std=c++20 -O2 -pthread -I.. md5_coro_latency.cpp ../md5.cpp ../md5_coro.cpp -o md5_coro_latency
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <random>
+#include <vector>
+#include "md5_coro.h"
+
+typedef uint8_t  u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef std::chrono::steady_clock clock_type;
+
+static constexpr u64 MESSAGE_BYTESIZE = 32 << 20; // The number of bytes in each digested buffer.
+static constexpr u32 ASYNC_COUNT      = 8;        // The number of buffers digested asynchronously at the same time.
+static constexpr u32 BLOCKING_COUNT   = 2;        // The number of buffers digested on the loop.
+static constexpr u32 POOL_THREADS     = 2;        // The number of threads in the pool.
+
+/// A coroutine that starts immediately and is not awaited by anyone.
+struct detached
+{
+	struct promise_type
+	{
+		detached get_return_object( void ) { return detached(); }
+		std::suspend_never initial_suspend( void ) { return std::suspend_never(); }
+		std::suspend_never final_suspend( void ) noexcept { return std::suspend_never(); }
+		void return_void( void ) {}
+		void unhandled_exception( void ) { std::terminate(); }
+	};
+};
+
+/// The state shared by the coroutines of a benchmark run.
+struct benchmark
+{
+	std::vector<u8>     message;
+	md5::sum            reference;
+	std::vector<double> lateness; // The lateness of each tick, in microseconds.
+	u32                 pending = 0;
+	u32                 failures = 0;
+	bool                stop_ticking = false;
+};
+
+/// Wakes up every millisecond on the loop and records how late each wake-up was.
+///
+/// @param loop the loop.
+/// @param bench the benchmark.
+static detached ticker(md5_loop_executor &loop, benchmark &bench)
+{
+	clock_type::time_point next = clock_type::now();
+	while (!bench.stop_ticking) {
+		next += std::chrono::milliseconds(1);
+		while (clock_type::now() < next) {
+			co_await loop.schedule();
+		}
+		bench.lateness.push_back(std::chrono::duration<double, std::micro>(clock_type::now() - next).count());
+	}
+	--bench.pending;
+}
+
+/// Digests the message on the pool, resuming on the loop.
+///
+/// @param bench the benchmark.
+/// @param options the options of the operation.
+static detached digest_async(benchmark &bench, md5_async_options options)
+{
+	md5 ctx;
+	const u64 byte_count = co_await md5_ingest_async(ctx, bench.message.data(), bench.message.size(), options);
+	if (byte_count != bench.message.size() || !(ctx.digest() == bench.reference)) {
+		++bench.failures;
+	}
+	--bench.pending;
+}
+
+/// Digests the message on the loop, blocking it.
+///
+/// @param loop the loop.
+/// @param bench the benchmark.
+static detached digest_blocking(md5_loop_executor &loop, benchmark &bench)
+{
+	co_await loop.schedule();
+	if (!(md5(bench.message.data(), bench.message.size()).digest() == bench.reference)) {
+		++bench.failures;
+	}
+	--bench.pending;
+}
+
+/// Runs the loop until only the ticker is left, then stops the ticker and prints its lateness.
+///
+/// @param loop the loop.
+/// @param bench the benchmark.
+/// @param name the name of the run.
+static void finish_run(md5_loop_executor &loop, benchmark &bench, const char *name)
+{
+	while (bench.pending > 1) {
+		loop.run_one(std::chrono::milliseconds(1));
+	}
+	bench.stop_ticking = true;
+	while (bench.pending > 0) {
+		loop.run_one(std::chrono::milliseconds(10));
+	}
+	std::vector<double> &lateness = bench.lateness;
+	std::sort(lateness.begin(), lateness.end());
+	if (lateness.empty()) {
+		printf("%s: no ticks\n", name);
+	} else {
+		printf("%s: %zu ticks, lateness p50 %.0f us, p99 %.0f us, max %.0f us\n", name, lateness.size(), lateness[lateness.size() / 2], lateness[lateness.size() * 99 / 100], lateness.back());
+	}
+	lateness.clear();
+	bench.stop_ticking = false;
+}
+
+int main( void )
+{
+	benchmark bench;
+	bench.message.resize(MESSAGE_BYTESIZE);
+	std::mt19937 rng(1);
+	for (u8 &byte : bench.message) {
+		byte = u8(rng());
+	}
+	bench.reference = md5(bench.message.data(), bench.message.size()).digest();
+
+	md5_loop_executor loop;
+	md5_thread_pool pool(POOL_THREADS);
+	md5_async_options options;
+	options.pool = &pool;
+	options.resume = loop.resumer();
+
+	// Baseline: the ticker alone.
+	bench.pending = 2; // The ticker and a placeholder released once the idle period is over.
+	ticker(loop, bench);
+	const clock_type::time_point idle_start = clock_type::now();
+	while (clock_type::now() - idle_start < std::chrono::milliseconds(300)) {
+		loop.run_one(std::chrono::milliseconds(1));
+	}
+	--bench.pending;
+	finish_run(loop, bench, "idle loop");
+
+	bench.pending = 1 + ASYNC_COUNT;
+	ticker(loop, bench);
+	for (u32 i = 0; i < ASYNC_COUNT; ++i) {
+		digest_async(bench, options);
+	}
+	finish_run(loop, bench, "md5_ingest_async");
+
+	bench.pending = 1 + BLOCKING_COUNT;
+	ticker(loop, bench);
+	for (u32 i = 0; i < BLOCKING_COUNT; ++i) {
+		digest_blocking(loop, bench);
+	}
+	finish_run(loop, bench, "md5::ingest on the loop");
+
+	if (bench.failures > 0) {
+		printf("%u digests did not match\n", bench.failures);
+		return 1;
+	}
+	return 0;
+}
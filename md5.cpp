@@ -9,6 +9,9 @@
 // WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
 
 #include <cstring>
+#if defined(__unix__) || defined(__APPLE__)
+	#include <sys/uio.h>
+#endif
 #include "md5.h"
 
 typedef uint8_t  u8;
@@ -34,6 +37,37 @@ bool is_lil( void )
 	return *reinterpret_cast<const u32*>(ENDIAN_BYTES) == 0x4030201;
 }
 
+#if defined(__GNUC__) || defined(__clang__)
+	#define MD5_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+	typedef u64 __attribute__((__may_alias__)) u64_alias;
+#elif defined(_MSC_VER)
+	#define MD5_NO_SANITIZE_ADDRESS __declspec(no_sanitize_address)
+	typedef u64 u64_alias;
+#else
+	#define MD5_NO_SANITIZE_ADDRESS
+	typedef u64 u64_alias;
+#endif
+
+/// Reads a word from a word-aligned address inside a zero-terminated string. The word may extend past the terminator, which is safe since an aligned word never crosses a page boundary, but which address sanitizers report as an out-of-bounds read. Sanitizing is therefore disabled for this read only.
+///
+/// @param src the word-aligned address.
+///
+/// @returns the word.
+MD5_NO_SANITIZE_ADDRESS static u64 load_aligned_word(const char *src)
+{
+	return *reinterpret_cast<const u64_alias*>(src);
+}
+
+/// Determines if any of the bytes in a word has a zero-value.
+///
+/// @param x the word to inspect.
+///
+/// @returns a boolean indicating true if at least one byte in the word is zero, and false otherwise.
+static bool has_zero_byte(u64 x)
+{
+	return ((x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL) != 0;
+}
+
 static constexpr u32 CHUNK_BYTESIZE = 512 / CHAR_BIT; // The number of bytes in a MD5 chunk.
 
 
@@ -148,6 +182,133 @@ char *md5::sum::sprint_bin(char *out) const
 	return out;
 }
 
+char *md5::sum::sprint_base64(char *out) const
+{
+	static constexpr char DIGITS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	for (u32 i = 0; i < sizeof(m_sum) - 1; i += 3, out += 4) {
+		const u32 v = (u32(m_sum.u8[i]) << 16) | (u32(m_sum.u8[i + 1]) << 8) | u32(m_sum.u8[i + 2]);
+		out[0] = DIGITS[v >> 18];
+		out[1] = DIGITS[(v >> 12) & 63];
+		out[2] = DIGITS[(v >> 6) & 63];
+		out[3] = DIGITS[v & 63];
+	}
+	const u32 last = m_sum.u8[sizeof(m_sum) - 1];
+	out[0] = DIGITS[last >> 2];
+	out[1] = DIGITS[(last & 3) << 4];
+	out[2] = '=';
+	out[3] = '=';
+	return out + 4;
+}
+
+char *md5::sum::sprint_base32(char *out) const
+{
+	static constexpr char DIGITS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+	for (u32 i = 0; i < sizeof(m_sum) - 1; i += 5, out += 8) {
+		const u64 v =
+			(u64(m_sum.u8[i]) << 32) | (u64(m_sum.u8[i + 1]) << 24) | (u64(m_sum.u8[i + 2]) << 16) |
+			(u64(m_sum.u8[i + 3]) << 8) | u64(m_sum.u8[i + 4]);
+		for (u32 j = 0; j < 8; ++j) {
+			out[j] = DIGITS[(v >> (35 - j * 5)) & 31];
+		}
+	}
+	const u32 last = m_sum.u8[sizeof(m_sum) - 1];
+	out[0] = DIGITS[last >> 3];
+	out[1] = DIGITS[(last & 7) << 2];
+	return out + 2;
+}
+
+/// Returns the value of a base64 digit.
+///
+/// @param c the digit.
+///
+/// @returns the value of the digit, or a value above 63 if the character is not a digit.
+static u32 base64_value(char c)
+{
+	if (c >= 'A' && c <= 'Z') { return u32(c - 'A'); }
+	if (c >= 'a' && c <= 'z') { return u32(c - 'a') + 26; }
+	if (c >= '0' && c <= '9') { return u32(c - '0') + 52; }
+	if (c == '+')             { return 62; }
+	if (c == '/')             { return 63; }
+	return 64;
+}
+
+/// Returns the value of a base32 digit.
+///
+/// @param c the digit.
+///
+/// @returns the value of the digit, or a value above 31 if the character is not a digit.
+static u32 base32_value(char c)
+{
+	if (c >= 'A' && c <= 'Z') { return u32(c - 'A'); }
+	if (c >= 'a' && c <= 'z') { return u32(c - 'a'); }
+	if (c >= '2' && c <= '7') { return u32(c - '2') + 26; }
+	return 32;
+}
+
+const char *md5::sum::sscan_base64(const char *in)
+{
+	for (u32 i = 0; i < 24; ++i) { // Do not read beyond the end of short strings.
+		if (in[i] == 0) {
+			return nullptr;
+		}
+	}
+	u8 bytes[sizeof(m_sum)];
+	u32 invalid = 0;
+	for (u32 i = 0; i < sizeof(m_sum) - 1; i += 3, in += 4) {
+		const u32 a = base64_value(in[0]);
+		const u32 b = base64_value(in[1]);
+		const u32 c = base64_value(in[2]);
+		const u32 d = base64_value(in[3]);
+		invalid |= (a | b | c | d) & 64;
+		const u32 v = (a << 18) | (b << 12) | (c << 6) | d;
+		bytes[i]     = u8(v >> 16);
+		bytes[i + 1] = u8(v >> 8);
+		bytes[i + 2] = u8(v);
+	}
+	const u32 a = base64_value(in[0]);
+	const u32 b = base64_value(in[1]);
+	invalid |= (a | b) & 64;
+	invalid |= b & 15; // Bits beyond the digest must be zero.
+	if (invalid != 0 || in[2] != '=' || in[3] != '=') {
+		return nullptr;
+	}
+	bytes[sizeof(m_sum) - 1] = u8((a << 2) | (b >> 4));
+	memcpy(m_sum.u8, bytes, sizeof(m_sum));
+	return in + 4;
+}
+
+const char *md5::sum::sscan_base32(const char *in)
+{
+	for (u32 i = 0; i < 26; ++i) { // Do not read beyond the end of short strings.
+		if (in[i] == 0) {
+			return nullptr;
+		}
+	}
+	u8 bytes[sizeof(m_sum)];
+	u32 invalid = 0;
+	for (u32 i = 0; i < sizeof(m_sum) - 1; i += 5, in += 8) {
+		u64 v = 0;
+		for (u32 j = 0; j < 8; ++j) {
+			const u32 x = base32_value(in[j]);
+			invalid |= x & 32;
+			v = (v << 5) | (x & 31);
+		}
+		for (u32 j = 0; j < 5; ++j) {
+			bytes[i + j] = u8(v >> (32 - j * 8));
+		}
+	}
+	const u32 a = base32_value(in[0]);
+	const u32 b = base32_value(in[1]);
+	invalid |= (a | b) & 32;
+	invalid |= b & 3; // Bits beyond the digest must be zero.
+	if (invalid != 0) {
+		return nullptr;
+	}
+	bytes[sizeof(m_sum) - 1] = u8((a << 3) | (b >> 2));
+	memcpy(m_sum.u8, bytes, sizeof(m_sum));
+	return in + 2;
+}
+
 std::string md5::sum::hex( void ) const
 {
 	static constexpr u64 SIZE = sizeof(m_sum) * 2;
@@ -166,6 +327,18 @@ std::string md5::sum::bin( void ) const
 	return std::string(str, size_t(SIZE));
 }
 
+std::string md5::sum::base64( void ) const
+{
+	char str[24];
+	return std::string(str, sprint_base64(str));
+}
+
+std::string md5::sum::base32( void ) const
+{
+	char str[26];
+	return std::string(str, sprint_base32(str));
+}
+
 void md5::blit(const u8 *src, u8 *dst)
 {
 	memcpy(dst, src, BYTES_PER_CHUNK);
@@ -179,7 +352,7 @@ void md5::blit(const u8 *src, u8 *dst, u32 num)
 
 bool md5::is_aligned(const void *mem)
 {
-	return (reinterpret_cast<uintptr_t>(mem) & (sizeof(u32) - 1)) != 0;
+	return (reinterpret_cast<uintptr_t>(mem) & (sizeof(u32) - 1)) == 0;
 }
 
 u32 md5::leftrotate(u32 x, u32 c)
@@ -187,7 +360,7 @@ u32 md5::leftrotate(u32 x, u32 c)
     return (x << c) | (x >> (32 - c));
 }
 
-void md5::process_chunk(const u32 *M, u32 *X) const
+void md5::process_chunk(const u32 *M, u32 *X)
 {
 	enum {a0,b0,c0,d0};
 
@@ -228,23 +401,22 @@ void md5::process_chunk(const u32 *M, u32 *X) const
 	X[d0] += D;
 }
 
-void md5::process_final_chunks(u32 *X) const
+void md5::process_final_chunks(const u8 *tail, u32 tail_size, u64 message_size, u32 *X)
 {
-
-	u64 byte_count = m_chunk_size;
+	u64 byte_count = tail_size;
 	union {
 		u32 w32[WORDS_PER_CHUNK];
 		u8  w8[BYTES_PER_CHUNK];
 	} chunk;
 
 	// Store size (64 bits) of original message in bits at the end of the message
-	u32 padding_size = BYTES_PER_CHUNK - (m_message_size % BYTES_PER_CHUNK);
+	u32 padding_size = BYTES_PER_CHUNK - (message_size % BYTES_PER_CHUNK);
 	if (padding_size < sizeof(u64) + sizeof(u8)) { // Padding must at least fit a 64-bit number to denote message length in bits and one 8-bit number as a terminating 1-bit. If it does not, we add another chunk to process. Note that since we always work on bytes, not bits, the length of the terminating 1-bit is 8 bits, with a value of 0x80.
 		padding_size += BYTES_PER_CHUNK;
 	}
 
 	// The message will always be padded in some way. Add a first '1' to the padding.
-	memcpy(chunk.w8, m_chunk.u8, byte_count);
+	memcpy(chunk.w8, tail, byte_count);
 	chunk.w8[byte_count] = 0x80;
 	memset(chunk.w8 + byte_count + 1, 0, BYTES_PER_CHUNK - (byte_count + 1));
 	byte_count += padding_size;
@@ -255,7 +427,7 @@ void md5::process_final_chunks(u32 *X) const
 	}
 
 	// One block left to process.
-	const u64 ORIGINAL_MESSAGE_BITSIZE = (m_message_size * CHAR_BIT);
+	const u64 ORIGINAL_MESSAGE_BITSIZE = (message_size * CHAR_BIT);
 	if (is_lil()) {
 		for (u32 i = 0; i < sizeof(u64); ++i) {
 			chunk.w8[BYTES_PER_CHUNK - sizeof(u64) + i] = reinterpret_cast<const char*>(&ORIGINAL_MESSAGE_BITSIZE)[i];
@@ -269,12 +441,28 @@ void md5::process_final_chunks(u32 *X) const
 	process_chunk(chunk.w32, X);
 }
 
+md5::sum md5::finalize(const u32 *state, const u8 *tail, u32 tail_size, u64 message_size)
+{
+	sum out;
+	memcpy(out.m_sum.u32, state, BYTES_PER_DIGEST);
+	process_final_chunks(tail, tail_size, message_size, out.m_sum.u32);
+	if (is_big()) { // Convert endianess if necessary - digests should always be in the same format no matter what
+		for (u32 i = 0; i < BYTES_PER_DIGEST; i += sizeof(u32)) {
+			for (u32 j = 0; j < sizeof(u32) >> 1; ++j) {
+				const u32 a = i + j;
+				const u32 b = i + sizeof(u32) - j - 1;
+				const u8 t = out.m_sum.u8[a];
+				out.m_sum.u8[a] = out.m_sum.u8[b];
+				out.m_sum.u8[b] = t;
+			}
+		}
+	}
+	return out;
+}
+
 md5::md5( void ) : m_message_size(0), m_chunk_size(0)
 {
-	m_state.u32[0] = 0x67452301; // A
-	m_state.u32[1] = 0xefcdab89; // B
-	m_state.u32[2] = 0x98badcfe; // C
-	m_state.u32[3] = 0x10325476; // D
+	md5_init(m_state.u32);
 }
 
 md5::md5(const char *message) : md5()
@@ -317,7 +505,32 @@ md5 md5::operator()(const void *message, u64 byte_count) const
 
 void md5::ingest(const char *message)
 {
-	ingest(message, u64(strlen(message)));
+	// Scans for the zero-terminator and ingests the message as the scan goes, so that every byte is only fetched from memory once instead of once by strlen and once more by ingest.
+	const char *end = message;
+
+	// Words are only read from word-aligned addresses since such reads can never cross into a page that does not contain the terminator.
+	while ((reinterpret_cast<uintptr_t>(end) & (sizeof(u64) - 1)) != 0) {
+		if (*end == 0) {
+			ingest(message, u64(end - message));
+			return;
+		}
+		++end;
+	}
+
+	for (;;) {
+		for (u32 i = 0; i < BYTES_PER_CHUNK; i += sizeof(u64), end += sizeof(u64)) {
+			if (has_zero_byte(load_aligned_word(end))) {
+				while (*end != 0) {
+					++end;
+				}
+				ingest(message, u64(end - message));
+				return;
+			}
+		}
+		// A whole chunk is known not to contain the terminator. Ingest it while it is still in cache.
+		ingest(message, u64(end - message));
+		message = end;
+	}
 }
 
 void md5::ingest(const void *message, u64 byte_count)
@@ -333,11 +546,11 @@ void md5::ingest(const void *message, u64 byte_count)
 			const u64 BYTES_REMAINING = BYTES_PER_CHUNK - m_chunk_size;
 			if (byte_count < BYTES_REMAINING) {
 				bytes_written = byte_count;
+				memcpy(m_chunk.u8 + m_chunk_size, msg, bytes_written);
 				m_chunk_size += byte_count;
-				blit(msg, m_chunk.u8, bytes_written);
 			} else {
 				bytes_written = BYTES_REMAINING;
-				blit(msg, m_chunk.u8, bytes_written);
+				memcpy(m_chunk.u8 + m_chunk_size, msg, bytes_written);
 				process_chunk(m_chunk.u32, m_state.u32);
 				m_chunk_size = 0;
 			}
@@ -348,23 +561,83 @@ void md5::ingest(const void *message, u64 byte_count)
 	}
 }
 
-md5::sum md5::digest( void ) const
+void md5::ingest_fragment(const u8 *fragment, u64 byte_count)
 {
-	sum out;
-	memcpy(out.m_sum.u8, m_state.u8, BYTES_PER_DIGEST);
-	process_final_chunks(out.m_sum.u32);
-	if (is_big()) { // Convert endianess if necessary - digests should always be in the same format no matter what
-		for (u32 i = 0; i < BYTES_PER_DIGEST; i += sizeof(u32)) {
-			for (u32 j = 0; j < sizeof(u32) >> 1; ++j) {
-				const u32 a = i + j;
-				const u32 b = i + sizeof(u32) - j - 1;
-				const u8 t = out.m_sum.u8[a];
-				out.m_sum.u8[a] = out.m_sum.u8[b];
-				out.m_sum.u8[b] = t;
-			}
+	if (byte_count == 0) { // Empty fragments may be null.
+		return;
+	}
+	m_message_size += byte_count;
+
+	// Complete a chunk left over from earlier fragments.
+	if (m_chunk_size > 0) {
+		const u64 fill_size = (BYTES_PER_CHUNK - m_chunk_size) < byte_count ? (BYTES_PER_CHUNK - m_chunk_size) : byte_count;
+		memcpy(m_chunk.u8 + m_chunk_size, fragment, size_t(fill_size));
+		m_chunk_size += u32(fill_size);
+		fragment += fill_size;
+		byte_count -= fill_size;
+		if (m_chunk_size < BYTES_PER_CHUNK) {
+			return;
 		}
+		process_chunk(m_chunk.u32, m_state.u32);
+		m_chunk_size = 0;
 	}
-	return out;
+
+	// Fragments are often unaligned, which md5_compress handles without going through the chunk buffer.
+	const u64 block_count = byte_count / BYTES_PER_CHUNK;
+	md5_compress(m_state.u32, fragment, block_count);
+	fragment += block_count * BYTES_PER_CHUNK;
+	byte_count -= block_count * BYTES_PER_CHUNK;
+
+	if (byte_count > 0) {
+		memcpy(m_chunk.u8, fragment, size_t(byte_count));
+		m_chunk_size = u32(byte_count);
+	}
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+void md5::ingest(const struct iovec *fragments, size_t fragment_count)
+{
+	for (size_t i = 0; i < fragment_count; ++i) {
+		ingest_fragment(reinterpret_cast<const u8*>(fragments[i].iov_base), u64(fragments[i].iov_len));
+	}
+}
+#endif
+
+#if __cplusplus >= 202002L
+void md5::ingest(std::span<const std::span<const std::byte>> fragments)
+{
+	for (const std::span<const std::byte> &fragment : fragments) {
+		ingest_fragment(reinterpret_cast<const u8*>(fragment.data()), u64(fragment.size()));
+	}
+}
+#endif
+
+md5::snapshot md5::save( void ) const
+{
+	snapshot state;
+	memcpy(state.state, m_state.u32, sizeof(state.state));
+	memcpy(state.chunk, m_chunk.u8, m_chunk_size);
+	memset(state.chunk + m_chunk_size, 0, sizeof(state.chunk) - m_chunk_size);
+	state.message_size = m_message_size;
+	state.chunk_size = m_chunk_size;
+	return state;
+}
+
+bool md5::restore(const snapshot &state)
+{
+	if (state.chunk_size != state.message_size % BYTES_PER_CHUNK) {
+		return false;
+	}
+	memcpy(m_state.u32, state.state, sizeof(m_state.u32));
+	memcpy(m_chunk.u8, state.chunk, state.chunk_size);
+	m_message_size = state.message_size;
+	m_chunk_size = state.chunk_size;
+	return true;
+}
+
+md5::sum md5::digest( void ) const
+{
+	return finalize(m_state.u32, m_chunk.u8, m_chunk_size, m_message_size);
 }
 
 md5::operator sum( void ) const
@@ -381,3 +654,375 @@ std::string md5hex(const void *message, u64 byte_count)
 {
 	return md5(message, byte_count).digest().hex();
 }
+
+void md5_init(u32 *state)
+{
+	state[0] = 0x67452301; // A
+	state[1] = 0xefcdab89; // B
+	state[2] = 0x98badcfe; // C
+	state[3] = 0x10325476; // D
+}
+
+void md5_compress(u32 *state, const void *blocks, u64 block_count)
+{
+	const u8 *msg = reinterpret_cast<const u8*>(blocks);
+	if (md5::is_aligned(msg)) {
+		for (u64 i = 0; i < block_count; ++i, msg += CHUNK_BYTESIZE) {
+			md5::process_chunk(reinterpret_cast<const u32*>(msg), state);
+		}
+	} else {
+		u32 chunk[CHUNK_BYTESIZE / sizeof(u32)];
+		for (u64 i = 0; i < block_count; ++i, msg += CHUNK_BYTESIZE) {
+			memcpy(chunk, msg, CHUNK_BYTESIZE);
+			md5::process_chunk(chunk, state);
+		}
+	}
+}
+
+md5::sum md5_finalize(const u32 *state, const void *tail, u64 tail_size, u64 message_size)
+{
+	const u8 *msg = reinterpret_cast<const u8*>(tail);
+	const u64 block_count = tail_size / CHUNK_BYTESIZE;
+	if (block_count > 0) {
+		u32 X[4];
+		memcpy(X, state, sizeof(X));
+		md5_compress(X, msg, block_count);
+		msg += block_count * CHUNK_BYTESIZE;
+		return md5::finalize(X, msg, u32(tail_size % CHUNK_BYTESIZE), message_size);
+	}
+	return md5::finalize(state, msg, u32(tail_size), message_size);
+}
+
+md5::sum md5_state_sum(const u32 *state)
+{
+	md5::sum out;
+	u8 *bytes = out;
+	for (u32 i = 0; i < 16; ++i) { // Digests are always stored in little endian order.
+		bytes[i] = u8(state[i / sizeof(u32)] >> ((i % sizeof(u32)) * CHAR_BIT));
+	}
+	return out;
+}
+
+/// Performs one step of the first round of the algorithm over all lanes.
+///
+/// @param a the lanes of the word to transform.
+/// @param b the lanes of the second word.
+/// @param c the lanes of the third word.
+/// @param d the lanes of the fourth word.
+/// @param m the lanes of the message word.
+/// @param k the additive constant of the step.
+/// @param s the amount to rotate by.
+static inline void lanes_f(u32 *a, const u32 *b, const u32 *c, const u32 *d, const u32 *m, u32 k, u32 s)
+{
+	for (u32 l = 0; l < MD5_LANES; ++l) {
+		const u32 x = a[l] + ((b[l] & c[l]) | ((~b[l]) & d[l])) + k + m[l];
+		a[l] = b[l] + ((x << s) | (x >> (32 - s)));
+	}
+}
+
+/// Performs one step of the second round of the algorithm over all lanes.
+///
+/// @param a the lanes of the word to transform.
+/// @param b the lanes of the second word.
+/// @param c the lanes of the third word.
+/// @param d the lanes of the fourth word.
+/// @param m the lanes of the message word.
+/// @param k the additive constant of the step.
+/// @param s the amount to rotate by.
+static inline void lanes_g(u32 *a, const u32 *b, const u32 *c, const u32 *d, const u32 *m, u32 k, u32 s)
+{
+	for (u32 l = 0; l < MD5_LANES; ++l) {
+		const u32 x = a[l] + ((d[l] & b[l]) | ((~d[l]) & c[l])) + k + m[l];
+		a[l] = b[l] + ((x << s) | (x >> (32 - s)));
+	}
+}
+
+/// Performs one step of the third round of the algorithm over all lanes.
+///
+/// @param a the lanes of the word to transform.
+/// @param b the lanes of the second word.
+/// @param c the lanes of the third word.
+/// @param d the lanes of the fourth word.
+/// @param m the lanes of the message word.
+/// @param k the additive constant of the step.
+/// @param s the amount to rotate by.
+static inline void lanes_h(u32 *a, const u32 *b, const u32 *c, const u32 *d, const u32 *m, u32 k, u32 s)
+{
+	for (u32 l = 0; l < MD5_LANES; ++l) {
+		const u32 x = a[l] + (b[l] ^ c[l] ^ d[l]) + k + m[l];
+		a[l] = b[l] + ((x << s) | (x >> (32 - s)));
+	}
+}
+
+/// Performs one step of the fourth round of the algorithm over all lanes.
+///
+/// @param a the lanes of the word to transform.
+/// @param b the lanes of the second word.
+/// @param c the lanes of the third word.
+/// @param d the lanes of the fourth word.
+/// @param m the lanes of the message word.
+/// @param k the additive constant of the step.
+/// @param s the amount to rotate by.
+static inline void lanes_i(u32 *a, const u32 *b, const u32 *c, const u32 *d, const u32 *m, u32 k, u32 s)
+{
+	for (u32 l = 0; l < MD5_LANES; ++l) {
+		const u32 x = a[l] + (c[l] ^ (b[l] | (~d[l]))) + k + m[l];
+		a[l] = b[l] + ((x << s) | (x >> (32 - s)));
+	}
+}
+
+void md5_compress_lanes(u32 *const *states, const void *const *blocks, u32 lane_count)
+{
+	// Structure-of-arrays layout, so that each step of the algorithm is the same operation over all lanes.
+	u32 M[16][MD5_LANES];
+	u32 X[4][MD5_LANES];
+
+	for (u32 l = 0; l < lane_count; ++l) {
+		const u8 *block = reinterpret_cast<const u8*>(blocks[l]);
+		for (u32 w = 0; w < 16; ++w) {
+			memcpy(&M[w][l], block + w * sizeof(u32), sizeof(u32));
+		}
+		for (u32 w = 0; w < 4; ++w) {
+			X[w][l] = states[l][w];
+		}
+	}
+	for (u32 l = lane_count; l < MD5_LANES; ++l) { // Unused lanes compute garbage that is discarded.
+		for (u32 w = 0; w < 16; ++w) {
+			M[w][l] = 0;
+		}
+		for (u32 w = 0; w < 4; ++w) {
+			X[w][l] = 0;
+		}
+	}
+
+	u32 *A = X[0];
+	u32 *B = X[1];
+	u32 *C = X[2];
+	u32 *D = X[3];
+	for (u32 i = 0; i < 16; i += 4) {
+		lanes_f(A, B, C, D, M[i    ], SineTable[i    ], ShiftTable[i    ]);
+		lanes_f(D, A, B, C, M[i + 1], SineTable[i + 1], ShiftTable[i + 1]);
+		lanes_f(C, D, A, B, M[i + 2], SineTable[i + 2], ShiftTable[i + 2]);
+		lanes_f(B, C, D, A, M[i + 3], SineTable[i + 3], ShiftTable[i + 3]);
+	}
+	for (u32 i = 16; i < 32; i += 4) {
+		lanes_g(A, B, C, D, M[(5*i + 1) % 16], SineTable[i    ], ShiftTable[i    ]);
+		lanes_g(D, A, B, C, M[(5*i + 6) % 16], SineTable[i + 1], ShiftTable[i + 1]);
+		lanes_g(C, D, A, B, M[(5*i + 11) % 16], SineTable[i + 2], ShiftTable[i + 2]);
+		lanes_g(B, C, D, A, M[(5*i + 16) % 16], SineTable[i + 3], ShiftTable[i + 3]);
+	}
+	for (u32 i = 32; i < 48; i += 4) {
+		lanes_h(A, B, C, D, M[(3*i + 5) % 16], SineTable[i    ], ShiftTable[i    ]);
+		lanes_h(D, A, B, C, M[(3*i + 8) % 16], SineTable[i + 1], ShiftTable[i + 1]);
+		lanes_h(C, D, A, B, M[(3*i + 11) % 16], SineTable[i + 2], ShiftTable[i + 2]);
+		lanes_h(B, C, D, A, M[(3*i + 14) % 16], SineTable[i + 3], ShiftTable[i + 3]);
+	}
+	for (u32 i = 48; i < 64; i += 4) {
+		lanes_i(A, B, C, D, M[(7*i) % 16], SineTable[i    ], ShiftTable[i    ]);
+		lanes_i(D, A, B, C, M[(7*i + 7) % 16], SineTable[i + 1], ShiftTable[i + 1]);
+		lanes_i(C, D, A, B, M[(7*i + 14) % 16], SineTable[i + 2], ShiftTable[i + 2]);
+		lanes_i(B, C, D, A, M[(7*i + 21) % 16], SineTable[i + 3], ShiftTable[i + 3]);
+	}
+
+	for (u32 l = 0; l < lane_count; ++l) {
+		states[l][0] += A[l];
+		states[l][1] += B[l];
+		states[l][2] += C[l];
+		states[l][3] += D[l];
+	}
+}
+
+/// The progress of a single message through 'md5_batch'. The message is the concatenation of a short head, shared by all messages in the batch, and a body.
+struct batch_lane
+{
+	u32       state[4];
+	u8        staging[CHUNK_BYTESIZE * 2]; // Blocks that straddle the head and body, and the padded final blocks of the message.
+	const u8 *head;
+	u64       head_size;
+	const u8 *body;
+	u64       body_size;
+	u64       prefix_size;                 // The number of bytes compressed into the initial state.
+	u64       offset;                      // The number of message bytes compressed so far.
+	u32       tail_blocks;                 // The number of padded final blocks. Zero until the final blocks have been prepared.
+	u32       tail_index;                  // The next padded final block to compress.
+	u64       item;                        // The index of the message in the batch.
+
+	/// Starts processing a message.
+	///
+	/// @param initial_state the state to start from.
+	/// @param prefix the number of bytes already compressed into 'initial_state'.
+	/// @param msg_head the head of the message.
+	/// @param msg_head_size the number of bytes in the head. Must be less than 64.
+	/// @param msg_body the body of the message.
+	/// @param msg_body_size the number of bytes in the body.
+	/// @param index the index of the message in the batch.
+	void start(const u32 *initial_state, u64 prefix, const u8 *msg_head, u64 msg_head_size, const void *msg_body, u64 msg_body_size, u64 index)
+	{
+		memcpy(state, initial_state, sizeof(state));
+		head        = msg_head;
+		head_size   = msg_head_size;
+		body        = reinterpret_cast<const u8*>(msg_body);
+		body_size   = msg_body_size;
+		prefix_size = prefix;
+		offset      = 0;
+		tail_blocks = 0;
+		tail_index  = 0;
+		item        = index;
+	}
+
+	/// Copies a range of the message, which may straddle the head and body.
+	///
+	/// @param from the offset into the message to copy from.
+	/// @param byte_count the number of bytes to copy.
+	/// @param dst the destination.
+	void copy(u64 from, u64 byte_count, u8 *dst) const
+	{
+		// Empty messages may be null, which memcpy does not accept even for zero bytes.
+		if (from < head_size && byte_count > 0) {
+			const u64 head_bytes = (head_size - from) < byte_count ? (head_size - from) : byte_count;
+			memcpy(dst, head + from, size_t(head_bytes));
+			dst += head_bytes;
+			from += head_bytes;
+			byte_count -= head_bytes;
+		}
+		if (byte_count > 0) {
+			memcpy(dst, body + (from - head_size), size_t(byte_count));
+		}
+	}
+
+	/// Returns the next block to compress, preparing the padded final blocks when the whole blocks of the message run out.
+	///
+	/// @returns the next block to compress.
+	const u8 *next_block( void )
+	{
+		if (tail_blocks == 0) {
+			const u64 message_size = head_size + body_size;
+			if (message_size - offset >= CHUNK_BYTESIZE) {
+				if (offset >= head_size) {
+					return body + (offset - head_size);
+				}
+				copy(offset, CHUNK_BYTESIZE, staging);
+				return staging;
+			}
+			const u32 remaining = u32(message_size - offset);
+			copy(offset, remaining, staging);
+			staging[remaining] = 0x80;
+			tail_blocks = (remaining + 1 + sizeof(u64) <= CHUNK_BYTESIZE) ? 1 : 2;
+			const u32 tail_size = tail_blocks * CHUNK_BYTESIZE;
+			memset(staging + remaining + 1, 0, tail_size - remaining - 1);
+			const u64 message_bitsize = (prefix_size + message_size) * CHAR_BIT;
+			for (u32 i = 0; i < sizeof(u64); ++i) {
+				staging[tail_size - sizeof(u64) + i] = u8(message_bitsize >> (i * CHAR_BIT));
+			}
+		}
+		return staging + tail_index * CHUNK_BYTESIZE;
+	}
+
+	/// Marks the block returned by 'next_block' as compressed.
+	///
+	/// @returns a boolean indicating true if the message has been fully processed, and false otherwise.
+	bool advance( void )
+	{
+		if (tail_blocks == 0) {
+			offset += CHUNK_BYTESIZE;
+			return false;
+		}
+		++tail_index;
+		return tail_index == tail_blocks;
+	}
+};
+
+/// Computes the digests of several independent messages, processing up to MD5_LANES messages in lock-step. Lanes are refilled with the next message in the batch as soon as they finish, so messages of different lengths do not leave lanes idle.
+///
+/// @param states the intermediate state of each message, or nullptr if all messages start from 'shared_state'.
+/// @param shared_state the intermediate state of all messages if 'states' is nullptr.
+/// @param prefix_size the number of bytes already compressed into each of the states.
+/// @param head the head shared by all messages, following the bytes already compressed into the states.
+/// @param head_size the number of bytes in the head. Must be less than 64.
+/// @param messages the remainders of the messages to digest.
+/// @param byte_counts the number of bytes in each message remainder.
+/// @param out the destination of the digest of each message.
+/// @param count the number of messages.
+static void batch(const u32 *const *states, const u32 *shared_state, u64 prefix_size, const u8 *head, u64 head_size, const void *const *messages, const u64 *byte_counts, md5::sum *out, u64 count)
+{
+	batch_lane lanes[MD5_LANES];
+	batch_lane *active[MD5_LANES];
+	batch_lane *idle[MD5_LANES];
+	u32 active_count = 0;
+	u32 idle_count = MD5_LANES;
+	u64 next_item = 0;
+
+	for (u32 l = 0; l < MD5_LANES; ++l) {
+		idle[l] = &lanes[l];
+	}
+
+	for (;;) {
+		// Refill idle lanes with the next messages in the batch.
+		while (idle_count > 0 && next_item < count) {
+			batch_lane *lane = idle[--idle_count];
+			lane->start(states != nullptr ? states[next_item] : shared_state, prefix_size, head, head_size, messages[next_item], byte_counts[next_item], next_item);
+			active[active_count++] = lane;
+			++next_item;
+		}
+		if (active_count == 0) {
+			break;
+		}
+
+		u32 *lane_states[MD5_LANES];
+		const void *lane_blocks[MD5_LANES];
+		for (u32 a = 0; a < active_count; ++a) {
+			lane_states[a] = active[a]->state;
+			lane_blocks[a] = active[a]->next_block();
+		}
+		md5_compress_lanes(lane_states, lane_blocks, active_count);
+
+		// Retire finished messages.
+		for (u32 a = 0; a < active_count;) {
+			if (active[a]->advance()) {
+				out[active[a]->item] = md5_state_sum(active[a]->state);
+				idle[idle_count++] = active[a];
+				active[a] = active[--active_count];
+			} else {
+				++a;
+			}
+		}
+	}
+}
+
+void md5_batch(const void *const *messages, const u64 *byte_counts, md5::sum *out, u64 count)
+{
+	u32 iv[4];
+	md5_init(iv);
+	batch(nullptr, iv, 0, nullptr, 0, messages, byte_counts, out, count);
+}
+
+void md5_batch_from_states(const u32 *const *states, u64 compressed_size, const void *const *messages, const u64 *byte_counts, md5::sum *out, u64 count)
+{
+	batch(states, nullptr, compressed_size, nullptr, 0, messages, byte_counts, out, count);
+}
+
+void md5_batch_prefixed(const void *prefix, u64 prefix_size, const void *const *messages, const u64 *byte_counts, md5::sum *out, u64 count)
+{
+	// Whole blocks of the prefix are compressed once and shared by all messages. The remainder of the prefix is prepended to each message as it is processed.
+	const u64 block_count = prefix_size / CHUNK_BYTESIZE;
+	const u64 compressed_size = block_count * CHUNK_BYTESIZE;
+	u32 midstate[4];
+	md5_init(midstate);
+	md5_compress(midstate, prefix, block_count);
+	batch(nullptr, midstate, compressed_size, reinterpret_cast<const u8*>(prefix) + compressed_size, prefix_size - compressed_size, messages, byte_counts, out, count);
+}
+
+void md5_copy(void *dst, const void *src, u64 byte_count, md5 &ctx)
+{
+	static constexpr u64 TILE_BYTESIZE = CHUNK_BYTESIZE * 64; // Small enough to still be in L1 cache after being copied.
+	u8 *out = reinterpret_cast<u8*>(dst);
+	const u8 *in = reinterpret_cast<const u8*>(src);
+	while (byte_count > 0) {
+		const u64 tile_size = byte_count < TILE_BYTESIZE ? byte_count : TILE_BYTESIZE;
+		memcpy(out, in, size_t(tile_size));
+		ctx.ingest(in, tile_size);
+		out += tile_size;
+		in += tile_size;
+		byte_count -= tile_size;
+	}
+}
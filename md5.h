@@ -14,7 +14,14 @@
 #include <cstdint>
 #include <climits>
 #include <string>
+#if __cplusplus >= 202002L
+	#include <cstddef>
+	#include <span>
+#endif
 
+#if defined(__unix__) || defined(__APPLE__)
+	struct iovec;
+#endif
 
 /// Processes messages of any length into a relatively unique identifyer with a length of 16 bytes. Functions by ingesting any number of messages via the 'ingest' function (alternatively via constructors and () operators) and finally outputting an MD5 sum via the 'digest' function. New messages can be appended even after a digest has been generated.
 ///
@@ -100,6 +107,32 @@ public:
 		/// @returns the pointer to the location in the sprint at which printing stopped.
 		char *sprint_bin(char *out) const;
 
+		/// Prints the digest in base64 format (RFC 4648), as used by the HTTP Content-MD5 header, to a string. Always prints 24 characters, including padding.
+		///
+		/// @param out the destination string of the print.
+		///
+		/// @returns the pointer to the location in the sprint at which printing stopped.
+		char *sprint_base64(char *out) const;
+		/// Prints the digest in base32 format (RFC 4648) to a string. Always prints 26 characters, without padding.
+		///
+		/// @param out the destination string of the print.
+		///
+		/// @returns the pointer to the location in the sprint at which printing stopped.
+		char *sprint_base32(char *out) const;
+
+		/// Reads a digest in base64 format (RFC 4648) from a string. Reads exactly 24 characters, including padding.
+		///
+		/// @param in the source string to read.
+		///
+		/// @returns the pointer to the location in the string at which reading stopped, or nullptr if the string did not contain a valid digest, in which case the digest is left unmodified.
+		const char *sscan_base64(const char *in);
+		/// Reads a digest in base32 format (RFC 4648) from a string. Reads exactly 26 characters, without padding. Lower case letters are accepted.
+		///
+		/// @param in the source string to read.
+		///
+		/// @returns the pointer to the location in the string at which reading stopped, or nullptr if the string did not contain a valid digest, in which case the digest is left unmodified.
+		const char *sscan_base32(const char *in);
+
 		/// Returns the human-readable hexadecimal format of the digest.
 		///
 		/// @returns the human-readable hexadecimal string.
@@ -108,8 +141,30 @@ public:
 		///
 		/// @returns the human-readable hexadecimal string.
 		std::string bin( void ) const;
+		/// Returns the base64 format of the digest.
+		///
+		/// @returns the base64 string.
+		std::string base64( void ) const;
+		/// Returns the base32 format of the digest.
+		///
+		/// @returns the base32 string.
+		std::string base32( void ) const;
+	};
+
+	/// The complete intermediate state of an md5 object. A snapshot can be stored and later restored to continue ingesting where it was taken, without ingesting the message again.
+	///
+	/// @note Snapshots contain message data and should be treated as sensitively as the message itself.
+	struct snapshot
+	{
+		uint32_t state[WORDS_PER_DIGEST]; // The state words after the last processed chunk.
+		uint8_t  chunk[BYTES_PER_CHUNK];  // The buffered bytes of the partial chunk. Only the first 'chunk_size' bytes are meaningful.
+		uint64_t message_size;            // The number of ingested bytes.
+		uint32_t chunk_size;              // The number of buffered bytes. Always 'message_size' modulo 64.
 	};
 
+	friend void md5_compress(uint32_t *state, const void *blocks, uint64_t block_count);
+	friend sum md5_finalize(const uint32_t *state, const void *tail, uint64_t tail_size, uint64_t message_size);
+
 private:
 	union {
 		uint32_t u32[WORDS_PER_DIGEST];
@@ -151,11 +206,28 @@ private:
 	///
 	/// @param M pointer to the message block.
 	/// @param X pointer to the destination block.
-	void process_chunk(const uint32_t *M, uint32_t *X) const;
-	/// Processes the remaining data in the block buffer so that a digest can be returned.
+	static void process_chunk(const uint32_t *M, uint32_t *X);
+	/// Ingests one fragment of a scattered message. Whole chunks are compressed in one run with md5_compress rather than one call to ingest at a time.
 	///
+	/// @param fragment the bytes of the fragment.
+	/// @param byte_count the number of bytes in the fragment.
+	void ingest_fragment(const uint8_t *fragment, uint64_t byte_count);
+	/// Pads and processes the remaining data of a message so that a digest can be returned.
+	///
+	/// @param tail the remaining data of the message that has not yet been processed.
+	/// @param tail_size the number of bytes in 'tail'. Must be less than 64.
+	/// @param message_size the total number of bytes in the message.
 	/// @param X the block to do a final transform on.
-	void process_final_chunks(uint32_t *X) const;
+	static void process_final_chunks(const uint8_t *tail, uint32_t tail_size, uint64_t message_size, uint32_t *X);
+	/// Finalizes a copy of an intermediate state into a digest.
+	///
+	/// @param state the intermediate state.
+	/// @param tail the remaining data of the message that has not yet been processed.
+	/// @param tail_size the number of bytes in 'tail'. Must be less than 64.
+	/// @param message_size the total number of bytes in the message.
+	///
+	/// @returns the digest.
+	static sum finalize(const uint32_t *state, const uint8_t *tail, uint32_t tail_size, uint64_t message_size);
 
 public:
 	/// Default constructor. Sets up the initial internal state.
@@ -214,6 +286,30 @@ public:
 	/// @param message the message to ingest.
 	/// @param byte_count the number of bytes in the message to ingest.
 	void ingest(const void *message, uint64_t byte_count);
+#if defined(__unix__) || defined(__APPLE__)
+	/// Ingest a message scattered over several buffers. The fragments are processed in order as one continuous message. Chunks that straddle two fragments are copied before processing, and so are whole chunks that are not 4-byte aligned, one chunk at a time.
+	///
+	/// @param fragments the array of fragments to ingest.
+	/// @param fragment_count the number of fragments in the array.
+	void ingest(const struct iovec *fragments, size_t fragment_count);
+#endif
+#if __cplusplus >= 202002L
+	/// Ingest a message scattered over several buffers. The fragments are processed in order as one continuous message. Chunks that straddle two fragments are copied before processing, and so are whole chunks that are not 4-byte aligned, one chunk at a time.
+	///
+	/// @param fragments the fragments to ingest.
+	void ingest(std::span<const std::span<const std::byte>> fragments);
+#endif
+
+	/// Returns a snapshot of the intermediate state.
+	///
+	/// @returns the snapshot.
+	snapshot save( void ) const;
+	/// Replaces the intermediate state with a snapshot.
+	///
+	/// @param state the snapshot.
+	///
+	/// @returns a boolean indicating true if the snapshot was restored, and false if it is inconsistent, in which case the state is left unmodified.
+	bool restore(const snapshot &state);
 
 	/// Returns the digest of all ingested messages.
 	///
@@ -239,5 +335,80 @@ std::string md5hex(const char *message);
 /// @returns a string containing the human-readable hexadecimal digest of the message.
 std::string md5hex(const void *message, uint64_t byte_count);
 
+/// Writes the initial MD5 state to a state array. Used together with 'md5_compress' and 'md5_finalize' to build constructions that need direct control over the state, such as HMAC or custom padding.
+///
+/// @param state the destination state array of 4 words.
+void md5_init(uint32_t *state);
+
+/// Transforms a state array by a sequence of whole message blocks.
+///
+/// @param state the state array of 4 words to transform.
+/// @param blocks the message blocks. Need not be aligned.
+/// @param block_count the number of 64-byte blocks in 'blocks'.
+void md5_compress(uint32_t *state, const void *blocks, uint64_t block_count);
+
+/// Pads and processes the final bytes of a message and returns the digest. The state array is left unmodified.
+///
+/// @param state the state array of 4 words, produced by 'md5_init' and 'md5_compress'.
+/// @param tail the bytes of the message that have not yet been compressed into 'state'.
+/// @param tail_size the number of bytes in 'tail'. Whole blocks in the tail are compressed before padding.
+/// @param message_size the total number of bytes in the message, including the bytes already compressed into 'state'. The number of already compressed bytes must be a multiple of 64.
+///
+/// @returns the digest of the message.
+md5::sum md5_finalize(const uint32_t *state, const void *tail, uint64_t tail_size, uint64_t message_size);
+
+/// Returns the digest that a state array represents, without padding or processing any more bytes. Used when a construction has already compressed its own padding, or to read an intermediate state such as a Merkle node.
+///
+/// @param state the state array of 4 words.
+///
+/// @returns the words of the state as a digest, in little endian byte order.
+md5::sum md5_state_sum(const uint32_t *state);
+
+/// The maximum number of independent states that 'md5_compress_lanes' transforms in lock-step.
+constexpr uint32_t MD5_LANES = 8;
+
+/// Transforms several independent states by one message block each. The states are processed in lock-step, which allows the compiler to map the lanes onto SIMD registers.
+///
+/// @param states the state arrays of 4 words to transform.
+/// @param blocks the message blocks of 64 bytes, one for each state. Need not be aligned.
+/// @param lane_count the number of states and blocks. Must not exceed MD5_LANES.
+void md5_compress_lanes(uint32_t *const *states, const void *const *blocks, uint32_t lane_count);
+
+/// Computes the digests of several independent messages. Up to MD5_LANES messages are processed in lock-step, which makes this faster than processing the messages one after another, especially for short messages.
+///
+/// @param messages the messages to digest.
+/// @param byte_counts the number of bytes in each message.
+/// @param out the destination of the digest of each message.
+/// @param count the number of messages.
+void md5_batch(const void *const *messages, const uint64_t *byte_counts, md5::sum *out, uint64_t count);
+
+/// Computes the digests of several independent messages, each continuing from an intermediate state. Up to MD5_LANES messages are processed in lock-step.
+///
+/// @param states the intermediate state arrays of 4 words of each message. The states are left unmodified.
+/// @param compressed_size the number of bytes already compressed into each of the states. Must be a multiple of 64.
+/// @param messages the remainders of the messages to digest.
+/// @param byte_counts the number of bytes in each message remainder.
+/// @param out the destination of the digest of each message.
+/// @param count the number of messages.
+void md5_batch_from_states(const uint32_t *const *states, uint64_t compressed_size, const void *const *messages, const uint64_t *byte_counts, md5::sum *out, uint64_t count);
+
+/// Computes the digests of several independent messages that all start with the same prefix. The whole blocks of the prefix are only compressed once, and up to MD5_LANES messages are processed in lock-step.
+///
+/// @param prefix the prefix shared by all messages.
+/// @param prefix_size the number of bytes in the prefix.
+/// @param messages the remainders of the messages to digest, following the prefix.
+/// @param byte_counts the number of bytes in each message remainder.
+/// @param out the destination of the digest of each message.
+/// @param count the number of messages.
+void md5_batch_prefixed(const void *prefix, uint64_t prefix_size, const void *const *messages, const uint64_t *byte_counts, md5::sum *out, uint64_t count);
+
+/// Copies a message from one location to another while ingesting it. The message is copied and ingested in small tiles so that the ingestion reads the bytes from cache, meaning the message is only fetched from memory once as opposed to when copying and ingesting separately.
+///
+/// @param dst the destination to copy the message to. Must not overlap with 'src'.
+/// @param src the message to copy and ingest.
+/// @param byte_count the number of bytes in the message to copy and ingest.
+/// @param ctx the state to ingest the message into.
+void md5_copy(void *dst, const void *src, uint64_t byte_count, md5 &ctx);
+
 #endif
 
@@ -0,0 +1,192 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#include <cstring>
+#include "md5_async_stream.h"
+
+typedef uint8_t  u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+static constexpr u32 SPIN_COUNT     = 256;     // The number of times a condition is polled before yielding.
+static constexpr u32 YIELD_COUNT    = 1024;    // The number of times a condition is polled while yielding before sleeping.
+static constexpr u32 MAX_QUEUE_SIZE = 1 << 20; // The largest number of writes that may be queued. Keeps rounding to a power of two from overflowing.
+
+constexpr u32 md5_async_stream::NO_CHUNK;
+
+template < typename ready_t >
+void md5_async_stream::wait(std::atomic<bool> &waiting, std::condition_variable &signal, const ready_t &ready)
+{
+	for (u32 i = 0; i < SPIN_COUNT; ++i) {
+		if (ready()) {
+			return;
+		}
+	}
+	// Sleeping and waking cost far more than a write, so a thread that was just busy keeps polling for a while.
+	for (u32 i = 0; i < YIELD_COUNT; ++i) {
+		std::this_thread::yield();
+		if (ready()) {
+			return;
+		}
+	}
+	// The flag is set before the condition is checked again, and the other thread publishes before it reads the flag, so one of them always sees the other.
+	std::unique_lock<std::mutex> guard(m_lock);
+	waiting.store(true);
+	signal.wait(guard, ready);
+	waiting.store(false);
+}
+
+void md5_async_stream::wake(std::atomic<bool> &waiting, std::condition_variable &signal)
+{
+	if (waiting.load()) {
+		std::lock_guard<std::mutex> guard(m_lock);
+		signal.notify_one();
+	}
+}
+
+void md5_async_stream::run( void )
+{
+	md5 ctx;
+	u64 tail = 0;
+	for (;;) {
+		wait(m_worker_waiting, m_work, [&]() { return m_head.load() != tail || m_closed.load(); });
+		if (m_head.load() == tail) {
+			break; // Closed, and everything written before closing has been digested.
+		}
+		const item next = m_items[size_t(tail & m_item_mask)];
+		ctx.ingest(next.data, next.size);
+		m_digested.store(m_digested.load(std::memory_order_relaxed) + next.size, std::memory_order_release);
+		if (next.chunk != NO_CHUNK) {
+			const u64 free_head = m_free_head.load(std::memory_order_relaxed);
+			m_free[size_t(free_head % m_free.size())] = next.chunk;
+			m_free_head.store(free_head + 1);
+		}
+		m_tail.store(++tail);
+		wake(m_writer_waiting, m_space);
+	}
+	m_result.set_value(ctx.digest());
+}
+
+void md5_async_stream::push(const u8 *data, u64 byte_count, u32 chunk)
+{
+	const u64 head = m_head.load(std::memory_order_relaxed);
+	if (head - m_tail_cache > m_item_mask) {
+		wait(m_writer_waiting, m_space, [&]() { return head - (m_tail_cache = m_tail.load()) <= m_item_mask; });
+	}
+	item &next = m_items[size_t(head & m_item_mask)];
+	next.data = data;
+	next.size = byte_count;
+	next.chunk = chunk;
+	m_head.store(head + 1);
+	wake(m_worker_waiting, m_work);
+}
+
+void md5_async_stream::submit( void )
+{
+	if (m_chunk != NO_CHUNK) {
+		push(m_pool.data() + m_chunk * MD5_ASYNC_CHUNK_SIZE, m_fill, m_chunk);
+		m_chunk = NO_CHUNK;
+	}
+}
+
+md5_async_stream::md5_async_stream(ownership mode, u32 queue_size, u64 pool_size) :
+	m_items(), m_pool(), m_free(), m_lock(), m_work(), m_space(), m_result(), m_worker(), m_mode(mode), m_item_mask(0),
+	m_head(0), m_closed(false), m_tail_cache(0), m_free_tail(0), m_written(0), m_chunk(NO_CHUNK), m_fill(0), m_finished(false),
+	m_tail(0), m_free_head(0), m_digested(0),
+	m_worker_waiting(false), m_writer_waiting(false)
+{
+	u32 item_count = 1;
+	while (item_count < queue_size && item_count < MAX_QUEUE_SIZE) {
+		item_count <<= 1;
+	}
+	m_items.resize(item_count);
+	m_item_mask = item_count - 1;
+
+	const u64 chunk_count = pool_size / MD5_ASYNC_CHUNK_SIZE < 2 ? 2 : pool_size / MD5_ASYNC_CHUNK_SIZE;
+	m_pool.resize(size_t(chunk_count * MD5_ASYNC_CHUNK_SIZE));
+	m_free.resize(size_t(chunk_count));
+	for (u32 i = 0; i < u32(chunk_count); ++i) {
+		m_free[i] = i;
+	}
+	m_free_head = chunk_count;
+
+	m_worker = std::thread(&md5_async_stream::run, this);
+}
+
+md5_async_stream::~md5_async_stream( void )
+{
+	if (!m_finished) {
+		finish();
+	}
+	m_worker.join();
+}
+
+bool md5_async_stream::write(const void *data, u64 byte_count)
+{
+	return write(data, byte_count, m_mode);
+}
+
+bool md5_async_stream::write(const void *data, u64 byte_count, ownership mode)
+{
+	if (m_finished) {
+		return false;
+	}
+	const u8 *bytes = reinterpret_cast<const u8*>(data);
+	m_written += byte_count;
+
+	if (mode == borrow) {
+		if (byte_count > 0) {
+			submit(); // Copied bytes written earlier must be digested first.
+			push(bytes, byte_count, NO_CHUNK);
+		}
+		return true;
+	}
+
+	// Small writes are gathered into pool chunks, so that most of them only cost a copy.
+	while (byte_count > 0) {
+		if (m_chunk == NO_CHUNK) {
+			wait(m_writer_waiting, m_space, [this]() { return m_free_head.load() != m_free_tail; });
+			m_chunk = m_free[size_t(m_free_tail++ % m_free.size())];
+			m_fill = 0;
+		}
+		const u64 copy_size = byte_count < MD5_ASYNC_CHUNK_SIZE - m_fill ? byte_count : MD5_ASYNC_CHUNK_SIZE - m_fill;
+		memcpy(m_pool.data() + m_chunk * MD5_ASYNC_CHUNK_SIZE + m_fill, bytes, size_t(copy_size));
+		m_fill += copy_size;
+		bytes += copy_size;
+		byte_count -= copy_size;
+		if (m_fill == MD5_ASYNC_CHUNK_SIZE) {
+			submit();
+		}
+	}
+	return true;
+}
+
+std::future<md5::sum> md5_async_stream::finish( void )
+{
+	if (m_finished) {
+		return std::future<md5::sum>(); // The future of the digest can only be retrieved once.
+	}
+	std::future<md5::sum> result = m_result.get_future();
+	submit();
+	m_finished = true;
+	m_closed.store(true);
+	wake(m_worker_waiting, m_work);
+	return result;
+}
+
+u64 md5_async_stream::written( void ) const
+{
+	return m_written;
+}
+
+u64 md5_async_stream::digested( void ) const
+{
+	return m_digested.load(std::memory_order_acquire);
+}
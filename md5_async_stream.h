@@ -0,0 +1,158 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_ASYNC_STREAM_H_INCLUDED__
+#define MD5_ASYNC_STREAM_H_INCLUDED__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "md5.h"
+
+/// The default number of writes that may be queued before the writer waits.
+constexpr uint32_t MD5_ASYNC_QUEUE_SIZE = 256;
+/// The default number of bytes in the pool that copied writes are stored in.
+constexpr uint64_t MD5_ASYNC_POOL_SIZE = 4 << 20;
+/// The number of bytes in each chunk of the pool.
+constexpr uint64_t MD5_ASYNC_CHUNK_SIZE = 64 << 10;
+
+/// Computes the digest of a message on a worker thread, so that the thread writing the message does not spend time digesting it. Writes are passed to the worker through a lock-free single-producer single-consumer queue.
+///
+/// @note Only one thread may write to a stream at a time.
+class md5_async_stream
+{
+public:
+	/// Determines what happens to the bytes of a write.
+	enum ownership
+	{
+		borrow, // The bytes are referenced, and must stay unmodified until they have been digested.
+		copy    // The bytes are copied into the pool, and may be reused as soon as the write returns.
+	};
+
+private:
+	/// A queued write.
+	struct item
+	{
+		const uint8_t *data;
+		uint64_t       size;
+		uint32_t       chunk; // The pool chunk that holds the bytes, or NO_CHUNK for borrowed bytes.
+	};
+
+	static constexpr uint32_t NO_CHUNK = ~uint32_t(0);
+
+private:
+	std::vector<item>              m_items;       // The queue of writes, indexed by position modulo its size.
+	std::vector<uint8_t>           m_pool;
+	std::vector<uint32_t>          m_free;        // The queue of free pool chunks, indexed by position modulo its size.
+	std::mutex                     m_lock;        // Only used to sleep and wake.
+	std::condition_variable        m_work;        // Signalled when the queue is no longer empty or the stream is closed.
+	std::condition_variable        m_space;       // Signalled when a queued write or pool chunk has been released.
+	std::promise<md5::sum>         m_result;
+	std::thread                    m_worker;
+	ownership                      m_mode;
+	uint32_t                       m_item_mask;
+
+	// Written by the writer.
+	alignas(64) std::atomic<uint64_t> m_head;     // The position of the next queued write.
+	std::atomic<bool>              m_closed;
+	uint64_t                       m_tail_cache;  // The last position of the worker that the writer has seen.
+	uint64_t                       m_free_tail;   // The position of the next free pool chunk.
+	uint64_t                       m_written;
+	uint32_t                       m_chunk;       // The pool chunk being filled, or NO_CHUNK.
+	uint64_t                       m_fill;        // The number of bytes in the pool chunk being filled.
+	bool                           m_finished;
+
+	// Written by the worker.
+	alignas(64) std::atomic<uint64_t> m_tail;     // The position of the next write to digest.
+	std::atomic<uint64_t>          m_free_head;   // The position at which the next released pool chunk is stored.
+	std::atomic<uint64_t>          m_digested;
+
+	// Rarely written, and read on every write, so kept apart from the positions.
+	alignas(64) std::atomic<bool>  m_worker_waiting;
+	std::atomic<bool>              m_writer_waiting;
+
+private:
+	/// Digests queued writes until the stream is closed and the queue is empty.
+	void run( void );
+
+	/// Waits until a condition holds, first spinning briefly and then sleeping.
+	///
+	/// @param waiting the flag that tells the other thread that this thread is sleeping.
+	/// @param signal the condition variable to sleep on.
+	/// @param ready the condition.
+	template < typename ready_t >
+	void wait(std::atomic<bool> &waiting, std::condition_variable &signal, const ready_t &ready);
+
+	/// Wakes the other thread if it is sleeping.
+	///
+	/// @param waiting the flag that tells whether the other thread is sleeping.
+	/// @param signal the condition variable it sleeps on.
+	void wake(std::atomic<bool> &waiting, std::condition_variable &signal);
+
+	/// Queues a write, waiting for space if the queue is full.
+	///
+	/// @param data the bytes.
+	/// @param byte_count the number of bytes.
+	/// @param chunk the pool chunk that holds the bytes, or NO_CHUNK.
+	void push(const uint8_t *data, uint64_t byte_count, uint32_t chunk);
+
+	/// Queues the pool chunk being filled, if any.
+	void submit( void );
+
+public:
+	/// Creates a stream and starts its worker thread.
+	///
+	/// @param mode the ownership of bytes passed to write without an explicit ownership.
+	/// @param queue_size the number of writes that may be queued before the writer waits. Rounded up to a power of two, and clamped to 2^20.
+	/// @param pool_size the number of bytes copied writes may occupy before the writer waits. Rounded up to at least two chunks.
+	explicit md5_async_stream(ownership mode = copy, uint32_t queue_size = MD5_ASYNC_QUEUE_SIZE, uint64_t pool_size = MD5_ASYNC_POOL_SIZE);
+	/// Finishes the stream if needed and stops its worker thread.
+	~md5_async_stream( void );
+
+	md5_async_stream(const md5_async_stream&) = delete;
+	md5_async_stream &operator=(const md5_async_stream&) = delete;
+
+	/// Adds bytes to the message using the ownership the stream was created with.
+	///
+	/// @param data the bytes.
+	/// @param byte_count the number of bytes.
+	///
+	/// @returns a boolean indicating true if the bytes were added, and false if the stream has been finished.
+	bool write(const void *data, uint64_t byte_count);
+	/// Adds bytes to the message.
+	///
+	/// @param data the bytes.
+	/// @param byte_count the number of bytes.
+	/// @param mode the ownership of the bytes. Borrowed bytes must stay unmodified until digested returns at least the value written returned after this call, or until the digest is available.
+	///
+	/// @returns a boolean indicating true if the bytes were added, and false if the stream has been finished.
+	bool write(const void *data, uint64_t byte_count, ownership mode);
+
+	/// Closes the stream. Writes made afterwards are rejected.
+	///
+	/// @returns the future digest of the message. Calls after the first return an invalid future, for which valid returns false.
+	std::future<md5::sum> finish( void );
+
+	/// Returns the number of bytes that have been added to the message.
+	///
+	/// @returns the number of bytes.
+	uint64_t written( void ) const;
+
+	/// Returns the number of bytes that the worker thread has digested. Thread-safe.
+	///
+	/// @returns the number of bytes.
+	uint64_t digested( void ) const;
+};
+
+#endif
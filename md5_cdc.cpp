@@ -0,0 +1,227 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "md5_cdc.h"
+
+typedef uint8_t  u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+static constexpr u32 MIN_AVG_SIZE = 64;
+static constexpr u32 NORMALIZATION = 2;              // The number of mask bits added before, and removed after, the average chunk size.
+static constexpr u32 HASH_GROUP    = MD5_LANES * 2; // Chunks digested per call to 'md5_batch' by the hashing thread.
+
+/// Returns the Gear table, which maps each byte value to a random 64-bit word. The words are the first 64 bits of the digests of the byte values.
+///
+/// @returns the table of 256 words.
+static const u64 *gear( void )
+{
+	struct table
+	{
+		u64 words[256];
+		table( void )
+		{
+			for (u32 i = 0; i < 256; ++i) {
+				const u8 byte = u8(i);
+				const md5::sum sum = md5(&byte, 1).digest();
+				const u8 *digest = sum;
+				words[i] = 0;
+				for (u32 j = 0; j < sizeof(u64); ++j) {
+					words[i] |= u64(digest[j]) << (j * 8);
+				}
+			}
+		}
+	};
+	static const table GEAR;
+	return GEAR.words;
+}
+
+/// Creates a mask of the most significant bits of a word. Gear hashes shift bytes towards the most significant bits, so those bits depend on the most bytes.
+///
+/// @param bit_count the number of bits in the mask.
+///
+/// @returns the mask.
+static u64 top_mask(u32 bit_count)
+{
+	return ~u64(0) << (64 - bit_count);
+}
+
+u64 md5_cdc::cut(const u8 *data, u64 byte_count, u64 &hash, u64 chunk_size, bool &found) const
+{
+	const u64 *table = gear();
+	u64 h = hash;
+	u64 i = 0;
+	found = false;
+
+	// No boundary can occur before the minimum chunk size, so those bytes are skipped without hashing.
+	if (chunk_size < m_min_size) {
+		const u64 skip = (m_min_size - chunk_size) < byte_count ? (m_min_size - chunk_size) : byte_count;
+		i += skip;
+		chunk_size += skip;
+	}
+	for (; i < byte_count && chunk_size < m_avg_size; ++i, ++chunk_size) {
+		h = (h << 1) + table[data[i]];
+		if ((h & m_mask_small) == 0) {
+			found = true;
+			hash = h;
+			return i + 1;
+		}
+	}
+	for (; i < byte_count && chunk_size < m_max_size; ++i, ++chunk_size) {
+		h = (h << 1) + table[data[i]];
+		if ((h & m_mask_large) == 0) {
+			found = true;
+			hash = h;
+			return i + 1;
+		}
+	}
+	found = chunk_size >= m_max_size;
+	hash = h;
+	return i;
+}
+
+md5_cdc::md5_cdc(u32 min_size, u32 avg_size, u32 max_size) : m_md5(), m_hash(0), m_offset(0), m_size(0)
+{
+	m_min_size = min_size < 1 ? 1 : min_size;
+	u32 bits = 0;
+	while (bits < 31 && (u64(1) << (bits + 1)) <= avg_size) {
+		++bits;
+	}
+	if (bits > 0 && bits < 31 && (u64(1) << bits) + (u64(1) << (bits - 1)) <= avg_size) { // Round to the nearest power of two.
+		++bits;
+	}
+	while ((u64(1) << bits) < m_min_size || (u64(1) << bits) < MIN_AVG_SIZE) {
+		++bits;
+	}
+	m_avg_size = u32(1) << bits;
+	m_max_size = max_size < m_avg_size ? m_avg_size : max_size;
+	m_mask_small = top_mask(bits + NORMALIZATION);
+	m_mask_large = top_mask(bits - NORMALIZATION);
+}
+
+void md5_cdc::ingest(const void *data, u64 byte_count, std::vector<md5_chunk> &out)
+{
+	const u8 *bytes = reinterpret_cast<const u8*>(data);
+	while (byte_count > 0) {
+		bool found;
+		const u64 size = cut(bytes, byte_count, m_hash, m_size, found);
+		m_md5(bytes, size);
+		m_size += size;
+		bytes += size;
+		byte_count -= size;
+		if (found) {
+			md5_chunk chunk = { m_offset, m_size, m_md5.digest() };
+			out.push_back(chunk);
+			m_offset += m_size;
+			m_size = 0;
+			m_hash = 0;
+			m_md5 = md5();
+		}
+	}
+}
+
+void md5_cdc::finish(std::vector<md5_chunk> &out)
+{
+	if (m_size > 0) {
+		md5_chunk chunk = { m_offset, m_size, m_md5.digest() };
+		out.push_back(chunk);
+	}
+	m_offset = 0;
+	m_size = 0;
+	m_hash = 0;
+	m_md5 = md5();
+}
+
+void md5_cdc::chunk(const void *data, u64 byte_count, std::vector<md5_chunk> &out, bool threaded) const
+{
+	const u8 *bytes = reinterpret_cast<const u8*>(data);
+	out.clear();
+
+	if (!threaded) {
+		for (u64 offset = 0; offset < byte_count;) {
+			u64 hash = 0;
+			bool found;
+			md5_chunk chunk;
+			chunk.offset = offset;
+			chunk.size = cut(bytes + offset, byte_count - offset, hash, 0, found);
+			out.push_back(chunk);
+			offset += chunk.size;
+		}
+		std::vector<const void*> messages(out.size());
+		std::vector<u64> byte_counts(out.size());
+		std::vector<md5::sum> sums(out.size());
+		for (size_t i = 0; i < out.size(); ++i) {
+			messages[i] = bytes + out[i].offset;
+			byte_counts[i] = out[i].size;
+		}
+		md5_batch(messages.data(), byte_counts.data(), sums.data(), out.size());
+		for (size_t i = 0; i < out.size(); ++i) {
+			out[i].sum = sums[i];
+		}
+		return;
+	}
+
+	// Chunks are published to the hashing thread as soon as their boundaries are found. Any access to 'out' holds the lock, since publishing may reallocate it.
+	std::mutex lock;
+	std::condition_variable published;
+	bool done = false;
+	std::thread hasher([&]() {
+		const void *messages[HASH_GROUP];
+		u64 byte_counts[HASH_GROUP];
+		md5::sum sums[HASH_GROUP];
+		size_t hashed = 0;
+		for (;;) {
+			size_t n;
+			{
+				std::unique_lock<std::mutex> guard(lock);
+				published.wait(guard, [&]() { return out.size() > hashed || done; });
+				if (out.size() == hashed) {
+					return;
+				}
+				n = (out.size() - hashed) < HASH_GROUP ? (out.size() - hashed) : HASH_GROUP;
+				for (size_t i = 0; i < n; ++i) {
+					messages[i] = bytes + out[hashed + i].offset;
+					byte_counts[i] = out[hashed + i].size;
+				}
+			}
+			md5_batch(messages, byte_counts, sums, n);
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				for (size_t i = 0; i < n; ++i) {
+					out[hashed + i].sum = sums[i];
+				}
+			}
+			hashed += n;
+		}
+	});
+
+	for (u64 offset = 0; offset < byte_count;) {
+		u64 hash = 0;
+		bool found;
+		md5_chunk chunk;
+		chunk.offset = offset;
+		chunk.size = cut(bytes + offset, byte_count - offset, hash, 0, found);
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			out.push_back(chunk);
+		}
+		published.notify_one();
+		offset += chunk.size;
+	}
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		done = true;
+	}
+	published.notify_one();
+	hasher.join();
+}
@@ -0,0 +1,83 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_CDC_H_INCLUDED__
+#define MD5_CDC_H_INCLUDED__
+
+#include <cstdint>
+#include <vector>
+#include "md5.h"
+
+/// A content-defined chunk of a stream.
+struct md5_chunk
+{
+	uint64_t offset; // The offset of the first byte of the chunk in the stream.
+	uint64_t size;   // The number of bytes in the chunk.
+	md5::sum sum;    // The digest of the chunk.
+};
+
+/// Splits a stream into content-defined chunks using FastCDC, and computes the digest of each chunk. Boundaries are found with a Gear rolling hash and normalized chunking, so that inserting or removing bytes only changes the chunks around the edit.
+///
+/// @note The Gear table is derived from the MD5 digests of the 256 byte values, which makes chunk boundaries stable across platforms and builds.
+class md5_cdc
+{
+private:
+	md5      m_md5;        // The digest of the current chunk so far.
+	uint64_t m_hash;       // The rolling hash of the current chunk.
+	uint64_t m_offset;     // The stream offset of the current chunk.
+	uint64_t m_size;       // The number of bytes in the current chunk.
+	uint64_t m_mask_small; // The stricter boundary mask, used before the average chunk size is reached.
+	uint64_t m_mask_large; // The looser boundary mask, used after the average chunk size is reached.
+	uint32_t m_min_size;
+	uint32_t m_avg_size;
+	uint32_t m_max_size;
+
+private:
+	/// Scans for the end of a chunk.
+	///
+	/// @param data the bytes following the bytes already in the chunk.
+	/// @param byte_count the number of bytes in 'data'.
+	/// @param hash the rolling hash of the chunk, updated by the scanned bytes.
+	/// @param chunk_size the number of bytes already in the chunk.
+	/// @param found set to true if the chunk ends within 'data', and false otherwise.
+	///
+	/// @returns the number of bytes in 'data' that belong to the chunk.
+	uint64_t cut(const uint8_t *data, uint64_t byte_count, uint64_t &hash, uint64_t chunk_size, bool &found) const;
+
+public:
+	/// Creates a chunker.
+	///
+	/// @param min_size the minimum number of bytes in a chunk. At least 1.
+	/// @param avg_size the targeted average number of bytes in a chunk. Rounded to a power of two, and at least 'min_size' and 64.
+	/// @param max_size the maximum number of bytes in a chunk. At least 'avg_size'.
+	explicit md5_cdc(uint32_t min_size = 2048, uint32_t avg_size = 8192, uint32_t max_size = 65536);
+
+	/// Ingests the next bytes of the stream.
+	///
+	/// @param data the bytes.
+	/// @param byte_count the number of bytes.
+	/// @param out the vector to append the chunks that end within 'data' to.
+	void ingest(const void *data, uint64_t byte_count, std::vector<md5_chunk> &out);
+
+	/// Ends the stream and restarts the chunker for a new stream.
+	///
+	/// @param out the vector to append the final chunk to, if the stream has remaining bytes.
+	void finish(std::vector<md5_chunk> &out);
+
+	/// Splits a whole buffer into chunks. The state of streams being ingested is not affected.
+	///
+	/// @param data the buffer.
+	/// @param byte_count the number of bytes in the buffer.
+	/// @param out the destination of the chunks. Cleared before writing.
+	/// @param threaded if true, the chunks are digested on a separate thread while boundaries are still being searched. If false, all boundaries are found first and the chunks are digested with 'md5_batch' on the calling thread.
+	void chunk(const void *data, uint64_t byte_count, std::vector<md5_chunk> &out, bool threaded = true) const;
+};
+
+#endif
@@ -0,0 +1,264 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#include "md5_coro.h"
+
+#if __cplusplus >= 202002L
+
+typedef uint8_t  u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+/// Resumes a coroutine as the options ask.
+///
+/// @param options the options.
+/// @param caller the coroutine.
+static void resume(const md5_async_options &options, std::coroutine_handle<> caller)
+{
+	if (options.resume) {
+		options.resume(caller);
+	} else {
+		caller.resume();
+	}
+}
+
+/// Returns the pool the options ask for.
+///
+/// @param options the options.
+///
+/// @returns the pool.
+static md5_thread_pool &pool(const md5_async_options &options)
+{
+	return options.pool != nullptr ? *options.pool : md5_thread_pool::shared();
+}
+
+void md5_thread_pool::run( void )
+{
+	std::unique_lock<std::mutex> guard(m_lock);
+	for (;;) {
+		m_work.wait(guard, [this]() { return !m_jobs.empty() || m_stopping; });
+		if (m_jobs.empty()) {
+			return;
+		}
+		std::function<void()> job = std::move(m_jobs.front());
+		m_jobs.pop_front();
+		guard.unlock();
+		job();
+		guard.lock();
+	}
+}
+
+md5_thread_pool::md5_thread_pool(u32 thread_count) : m_jobs(), m_threads(), m_lock(), m_work(), m_stopping(false)
+{
+	if (thread_count == 0) {
+		thread_count = std::thread::hardware_concurrency();
+	}
+	if (thread_count == 0) {
+		thread_count = 1;
+	}
+	for (u32 i = 0; i < thread_count; ++i) {
+		m_threads.emplace_back(&md5_thread_pool::run, this);
+	}
+}
+
+md5_thread_pool::~md5_thread_pool( void )
+{
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+		m_stopping = true;
+	}
+	m_work.notify_all();
+	for (std::thread &thread : m_threads) {
+		thread.join();
+	}
+}
+
+void md5_thread_pool::submit(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+		m_jobs.push_back(std::move(job));
+	}
+	m_work.notify_one();
+}
+
+md5_thread_pool &md5_thread_pool::shared( void )
+{
+	static md5_thread_pool pool;
+	return pool;
+}
+
+md5_loop_executor::schedule_operation::schedule_operation(md5_loop_executor &loop) : m_loop(loop)
+{}
+
+bool md5_loop_executor::schedule_operation::await_ready( void ) const
+{
+	return false;
+}
+
+void md5_loop_executor::schedule_operation::await_suspend(std::coroutine_handle<> caller)
+{
+	m_loop.post(caller);
+}
+
+void md5_loop_executor::schedule_operation::await_resume( void ) const
+{}
+
+void md5_loop_executor::post(std::coroutine_handle<> coroutine)
+{
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+		m_ready.push_back(coroutine);
+	}
+	m_posted.notify_one();
+}
+
+bool md5_loop_executor::run_one( void )
+{
+	return run_one(std::chrono::steady_clock::duration::zero());
+}
+
+bool md5_loop_executor::run_one(std::chrono::steady_clock::duration timeout)
+{
+	std::coroutine_handle<> next;
+	{
+		std::unique_lock<std::mutex> guard(m_lock);
+		if (!m_posted.wait_for(guard, timeout, [this]() { return !m_ready.empty(); })) {
+			return false;
+		}
+		next = m_ready.front();
+		m_ready.pop_front();
+	}
+	next.resume();
+	return true;
+}
+
+u64 md5_loop_executor::poll( void )
+{
+	u64 count = 0;
+	while (run_one()) {
+		++count;
+	}
+	return count;
+}
+
+std::function<void(std::coroutine_handle<>)> md5_loop_executor::resumer( void )
+{
+	return [this](std::coroutine_handle<> coroutine) { post(coroutine); };
+}
+
+md5_loop_executor::schedule_operation md5_loop_executor::schedule( void )
+{
+	return schedule_operation(*this);
+}
+
+void md5_ingest_operation::step( void )
+{
+	if (m_done == m_size || m_options.stop.stop_requested()) {
+		resume(m_options, m_caller);
+		return;
+	}
+	const u64 slice_size = (m_size - m_done) < m_options.slice_size ? (m_size - m_done) : m_options.slice_size;
+	m_ctx.ingest(m_data + m_done, slice_size);
+	m_done += slice_size;
+	// Queued behind other work rather than looping, so that concurrent operations share the pool fairly.
+	pool(m_options).submit([this]() { step(); });
+}
+
+md5_ingest_operation::md5_ingest_operation(md5 &ctx, const void *message, u64 byte_count, md5_async_options options) :
+	m_ctx(ctx), m_data(reinterpret_cast<const u8*>(message)), m_size(byte_count), m_done(0), m_options(std::move(options)), m_caller()
+{
+	if (m_options.slice_size == 0) {
+		m_options.slice_size = MD5_CORO_SLICE_SIZE;
+	}
+}
+
+bool md5_ingest_operation::await_ready( void ) const
+{
+	return m_size == 0;
+}
+
+void md5_ingest_operation::await_suspend(std::coroutine_handle<> caller)
+{
+	m_caller = caller;
+	pool(m_options).submit([this]() { step(); });
+}
+
+u64 md5_ingest_operation::await_resume( void ) const
+{
+	return m_done;
+}
+
+void md5_file_operation::step( void )
+{
+	if (!m_file.is_open()) {
+		m_file.open(m_path, std::ios::binary);
+		if (!m_file.is_open()) {
+			resume(m_options, m_caller);
+			return;
+		}
+		m_buffer.resize(size_t(m_options.slice_size));
+	}
+	if (m_options.stop.stop_requested()) {
+		resume(m_options, m_caller);
+		return;
+	}
+	m_file.read(m_buffer.data(), std::streamsize(m_buffer.size()));
+	m_ctx.ingest(m_buffer.data(), u64(m_file.gcount()));
+	if (m_file.eof()) {
+		m_sum = m_ctx.digest();
+		resume(m_options, m_caller);
+	} else if (!m_file) {
+		resume(m_options, m_caller);
+	} else {
+		pool(m_options).submit([this]() { step(); });
+	}
+}
+
+md5_file_operation::md5_file_operation(const char *path, md5_async_options options) :
+	m_path(path), m_file(), m_buffer(), m_ctx(), m_sum(), m_options(std::move(options)), m_caller()
+{
+	if (m_options.slice_size == 0) {
+		m_options.slice_size = MD5_CORO_SLICE_SIZE;
+	}
+}
+
+bool md5_file_operation::await_ready( void ) const
+{
+	return false;
+}
+
+void md5_file_operation::await_suspend(std::coroutine_handle<> caller)
+{
+	m_caller = caller;
+	pool(m_options).submit([this]() { step(); });
+}
+
+std::optional<md5::sum> md5_file_operation::await_resume( void )
+{
+	return m_sum;
+}
+
+md5_ingest_operation md5_ingest_async(md5 &ctx, const void *message, u64 byte_count, md5_async_options options)
+{
+	return md5_ingest_operation(ctx, message, byte_count, std::move(options));
+}
+
+md5_ingest_operation md5_ingest_async(md5 &ctx, std::span<const u8> message, md5_async_options options)
+{
+	return md5_ingest_operation(ctx, message.data(), u64(message.size()), std::move(options));
+}
+
+md5_file_operation md5_file_async(const char *path, md5_async_options options)
+{
+	return md5_file_operation(path, std::move(options));
+}
+
+#endif
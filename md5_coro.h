@@ -0,0 +1,228 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_CORO_H_INCLUDED__
+#define MD5_CORO_H_INCLUDED__
+
+// Coroutines require C++20. The module is empty when compiled as an earlier standard.
+#if __cplusplus >= 202002L
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+#include "md5.h"
+
+/// The default number of bytes digested by a pool thread before the operation yields to other queued work.
+constexpr uint64_t MD5_CORO_SLICE_SIZE = 256 << 10;
+
+/// A pool of threads that runs queued jobs in the order they were submitted.
+class md5_thread_pool
+{
+private:
+	std::deque< std::function<void()> > m_jobs;
+	std::vector<std::thread>            m_threads;
+	std::mutex                          m_lock;
+	std::condition_variable             m_work;
+	bool                                m_stopping;
+
+private:
+	/// Runs queued jobs until the pool is stopping and no jobs remain.
+	void run( void );
+
+public:
+	/// Creates a pool and starts its threads.
+	///
+	/// @param thread_count the number of threads. Zero uses the number of hardware threads.
+	explicit md5_thread_pool(uint32_t thread_count = 0);
+	/// Runs the remaining jobs and stops the threads.
+	~md5_thread_pool( void );
+
+	md5_thread_pool(const md5_thread_pool&) = delete;
+	md5_thread_pool &operator=(const md5_thread_pool&) = delete;
+
+	/// Queues a job. Thread-safe.
+	///
+	/// @param job the job.
+	void submit(std::function<void()> job);
+
+	/// Returns a pool shared by operations that do not specify one. Created on first use.
+	///
+	/// @returns the pool.
+	static md5_thread_pool &shared( void );
+};
+
+/// A single-threaded loop that resumes coroutines posted to it, for driving coroutines without an external event loop.
+class md5_loop_executor
+{
+private:
+	std::deque< std::coroutine_handle<> > m_ready;
+	std::mutex                            m_lock;
+	std::condition_variable               m_posted;
+
+public:
+	/// Resumes the awaiting coroutine on the loop.
+	class schedule_operation
+	{
+	private:
+		md5_loop_executor &m_loop;
+
+	public:
+		explicit schedule_operation(md5_loop_executor &loop);
+		bool await_ready( void ) const;
+		void await_suspend(std::coroutine_handle<> caller);
+		void await_resume( void ) const;
+	};
+
+public:
+	md5_loop_executor( void ) = default;
+
+	md5_loop_executor(const md5_loop_executor&) = delete;
+	md5_loop_executor &operator=(const md5_loop_executor&) = delete;
+
+	/// Queues a coroutine to be resumed by the loop. Thread-safe.
+	///
+	/// @param coroutine the coroutine.
+	void post(std::coroutine_handle<> coroutine);
+
+	/// Resumes the next queued coroutine, if any, without waiting.
+	///
+	/// @returns a boolean indicating true if a coroutine was resumed, and false if none was queued.
+	bool run_one( void );
+
+	/// Resumes the next queued coroutine, waiting for one to be queued if needed.
+	///
+	/// @param timeout the longest time to wait.
+	///
+	/// @returns a boolean indicating true if a coroutine was resumed, and false if none was queued in time.
+	bool run_one(std::chrono::steady_clock::duration timeout);
+
+	/// Resumes queued coroutines, including ones queued meanwhile, until none remain.
+	///
+	/// @returns the number of coroutines resumed.
+	uint64_t poll( void );
+
+	/// Returns a function that resumes coroutines on the loop, for use as md5_async_options::resume.
+	///
+	/// @returns the function.
+	std::function<void(std::coroutine_handle<>)> resumer( void );
+
+	/// Returns an awaitable that continues the awaiting coroutine on the loop.
+	///
+	/// @returns the awaitable.
+	schedule_operation schedule( void );
+};
+
+/// Options for asynchronous operations.
+struct md5_async_options
+{
+	md5_thread_pool                               *pool       = nullptr;             // The pool that digests. Null uses md5_thread_pool::shared.
+	std::function<void(std::coroutine_handle<>)>   resume;                           // Resumes the awaiting coroutine. Empty resumes it on the pool thread.
+	std::stop_token                                stop;                             // Cancels the operation between slices.
+	uint64_t                                       slice_size = MD5_CORO_SLICE_SIZE; // The number of bytes digested before yielding to other queued work.
+};
+
+/// Digests bytes into an existing context on a thread pool. Returned by md5_ingest_async.
+///
+/// @note The context and the bytes must stay valid until the operation completes.
+class md5_ingest_operation
+{
+private:
+	md5                     &m_ctx;
+	const uint8_t           *m_data;
+	uint64_t                 m_size;
+	uint64_t                 m_done;
+	md5_async_options        m_options;
+	std::coroutine_handle<>  m_caller;
+
+private:
+	/// Digests one slice and queues the next, or resumes the caller when done or cancelled.
+	void step( void );
+
+public:
+	md5_ingest_operation(md5 &ctx, const void *message, uint64_t byte_count, md5_async_options options);
+
+	md5_ingest_operation(const md5_ingest_operation&) = delete;
+	md5_ingest_operation &operator=(const md5_ingest_operation&) = delete;
+
+	bool await_ready( void ) const;
+	void await_suspend(std::coroutine_handle<> caller);
+	/// @returns the number of bytes digested, which is less than requested if the operation was cancelled.
+	uint64_t await_resume( void ) const;
+};
+
+/// Digests a file on a thread pool. Returned by md5_file_async.
+class md5_file_operation
+{
+private:
+	std::string              m_path;
+	std::ifstream            m_file;
+	std::vector<char>        m_buffer;
+	md5                      m_ctx;
+	std::optional<md5::sum>  m_sum;
+	md5_async_options        m_options;
+	std::coroutine_handle<>  m_caller;
+
+private:
+	/// Digests one slice and queues the next, or resumes the caller when done, failed or cancelled.
+	void step( void );
+
+public:
+	md5_file_operation(const char *path, md5_async_options options);
+
+	md5_file_operation(const md5_file_operation&) = delete;
+	md5_file_operation &operator=(const md5_file_operation&) = delete;
+
+	bool await_ready( void ) const;
+	void await_suspend(std::coroutine_handle<> caller);
+	/// @returns the digest of the file, or nothing if the file could not be read or the operation was cancelled.
+	std::optional<md5::sum> await_resume( void );
+};
+
+/// Digests bytes into an existing context without blocking the awaiting coroutine's thread. Large inputs are digested in slices, between which other queued work runs and cancellation is checked.
+///
+/// @param ctx the context to ingest into. Bytes digested before a cancellation remain ingested.
+/// @param message the bytes.
+/// @param byte_count the number of bytes.
+/// @param options the pool, resumption and cancellation to use.
+///
+/// @returns an awaitable yielding the number of bytes digested.
+md5_ingest_operation md5_ingest_async(md5 &ctx, const void *message, uint64_t byte_count, md5_async_options options = {});
+
+/// Digests bytes into an existing context without blocking the awaiting coroutine's thread.
+///
+/// @param ctx the context to ingest into. Bytes digested before a cancellation remain ingested.
+/// @param message the bytes.
+/// @param options the pool, resumption and cancellation to use.
+///
+/// @returns an awaitable yielding the number of bytes digested.
+md5_ingest_operation md5_ingest_async(md5 &ctx, std::span<const uint8_t> message, md5_async_options options = {});
+
+/// Digests a file without blocking the awaiting coroutine's thread. The file is read and digested in slices on the pool.
+///
+/// @param path the path of the file.
+/// @param options the pool, resumption and cancellation to use.
+///
+/// @returns an awaitable yielding the digest, or nothing on failure or cancellation.
+md5_file_operation md5_file_async(const char *path, md5_async_options options = {});
+
+#endif
+
+#endif
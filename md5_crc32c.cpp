@@ -0,0 +1,142 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#include <cstring>
+#if defined(__SSE4_2__)
+	#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+	#include <arm_acle.h>
+#endif
+#include "md5_crc32c.h"
+
+typedef uint8_t  u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+static constexpr u32 CRC32C_POLYNOMIAL = 0x82f63b78; // The reflected Castagnoli polynomial.
+static constexpr u64 TILE_BYTESIZE     = 4096;       // Small enough to still be in L1 cache after being checksummed.
+
+#if !defined(__SSE4_2__) && !defined(__ARM_FEATURE_CRC32)
+/// Lookup tables for slicing-by-8 CRC computation.
+struct crc32c_tables
+{
+	u32 t[8][256];
+
+	/// Computes the tables.
+	crc32c_tables( void )
+	{
+		for (u32 i = 0; i < 256; ++i) {
+			u32 crc = i;
+			for (u32 j = 0; j < 8; ++j) {
+				crc = (crc >> 1) ^ (CRC32C_POLYNOMIAL & (0 - (crc & 1)));
+			}
+			t[0][i] = crc;
+		}
+		for (u32 i = 0; i < 256; ++i) {
+			for (u32 j = 1; j < 8; ++j) {
+				t[j][i] = (t[j - 1][i] >> 8) ^ t[0][t[j - 1][i] & 0xff];
+			}
+		}
+	}
+};
+
+/// Returns the lookup tables, computing them on first use.
+///
+/// @returns the lookup tables.
+static const crc32c_tables &tables( void )
+{
+	static const crc32c_tables TABLES;
+	return TABLES;
+}
+#endif
+
+u32 md5_crc32c::update_crc(u32 crc, const u8 *message, u64 byte_count)
+{
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+	while (byte_count >= sizeof(u64)) {
+		u64 word;
+		memcpy(&word, message, sizeof(u64));
+	#if defined(__SSE4_2__)
+		crc = u32(_mm_crc32_u64(crc, word));
+	#else
+		crc = __crc32cd(crc, word);
+	#endif
+		message += sizeof(u64);
+		byte_count -= sizeof(u64);
+	}
+	while (byte_count > 0) {
+	#if defined(__SSE4_2__)
+		crc = _mm_crc32_u8(crc, *message);
+	#else
+		crc = __crc32cb(crc, *message);
+	#endif
+		++message;
+		--byte_count;
+	}
+#else
+	const crc32c_tables &T = tables();
+	while (byte_count >= sizeof(u64)) {
+		// The slicing-by-8 algorithm reads the words in little endian order.
+		const u32 lo = crc ^ (u32(message[0]) | (u32(message[1]) << 8) | (u32(message[2]) << 16) | (u32(message[3]) << 24));
+		const u32 hi = u32(message[4]) | (u32(message[5]) << 8) | (u32(message[6]) << 16) | (u32(message[7]) << 24);
+		crc =
+			T.t[7][lo & 0xff] ^ T.t[6][(lo >> 8) & 0xff] ^ T.t[5][(lo >> 16) & 0xff] ^ T.t[4][lo >> 24] ^
+			T.t[3][hi & 0xff] ^ T.t[2][(hi >> 8) & 0xff] ^ T.t[1][(hi >> 16) & 0xff] ^ T.t[0][hi >> 24];
+		message += sizeof(u64);
+		byte_count -= sizeof(u64);
+	}
+	while (byte_count > 0) {
+		crc = (crc >> 8) ^ T.t[0][(crc ^ *message) & 0xff];
+		++message;
+		--byte_count;
+	}
+#endif
+	return crc;
+}
+
+md5_crc32c::md5_crc32c( void ) : m_md5(), m_crc(0xffffffff)
+{}
+
+md5_crc32c::md5_crc32c(const char *message) : md5_crc32c()
+{
+	ingest(message);
+}
+
+md5_crc32c::md5_crc32c(const void *message, u64 byte_count) : md5_crc32c()
+{
+	ingest(message, byte_count);
+}
+
+void md5_crc32c::ingest(const char *message)
+{
+	ingest(message, u64(strlen(message)));
+}
+
+void md5_crc32c::ingest(const void *message, u64 byte_count)
+{
+	const u8 *msg = reinterpret_cast<const u8*>(message);
+	while (byte_count > 0) {
+		const u64 tile_size = byte_count < TILE_BYTESIZE ? byte_count : TILE_BYTESIZE;
+		m_crc = update_crc(m_crc, msg, tile_size);
+		m_md5.ingest(msg, tile_size);
+		msg += tile_size;
+		byte_count -= tile_size;
+	}
+}
+
+md5::sum md5_crc32c::digest( void ) const
+{
+	return m_md5.digest();
+}
+
+u32 md5_crc32c::crc( void ) const
+{
+	return ~m_crc;
+}
@@ -0,0 +1,69 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_CRC32C_H_INCLUDED__
+#define MD5_CRC32C_H_INCLUDED__
+
+#include <cstdint>
+#include "md5.h"
+
+/// Computes both the MD5 digest and the CRC32C (Castagnoli) checksum of messages in a single pass over memory. Messages are ingested in small tiles, where each tile is first checksummed and then ingested into the MD5 state while it is still in cache.
+///
+/// @note The hardware CRC32 instructions are used when the target supports them at compile time (SSE 4.2 or ARMv8 CRC), otherwise a portable table-driven implementation is used.
+class md5_crc32c
+{
+private:
+	md5      m_md5;
+	uint32_t m_crc;
+
+private:
+	/// Updates the CRC register with a message.
+	///
+	/// @param crc the current CRC register.
+	/// @param message the message to checksum.
+	/// @param byte_count the number of bytes in the message.
+	///
+	/// @returns the updated CRC register.
+	static uint32_t update_crc(uint32_t crc, const uint8_t *message, uint64_t byte_count);
+
+public:
+	/// Default constructor. Sets up the initial internal state.
+	md5_crc32c( void );
+	/// Ingest an initial message. Length is inferred from zero-terminator.
+	///
+	/// @param message pointer to a message to ingest.
+	md5_crc32c(const char *message);
+	/// Ingest an initial message. Explicit length.
+	///
+	/// @param pointer to a message to ingest.
+	/// @param byte_count the number of bytes in the message to ingest.
+	md5_crc32c(const void *message, uint64_t byte_count);
+
+	/// Ingest a message. Length is inferred from zero-terminator.
+	///
+	/// @param message the message to ingest.
+	void ingest(const char *message);
+	/// Ingest a message. Explicit length.
+	///
+	/// @param message the message to ingest.
+	/// @param byte_count the number of bytes in the message to ingest.
+	void ingest(const void *message, uint64_t byte_count);
+
+	/// Returns the MD5 digest of all ingested messages.
+	///
+	/// @returns the digest.
+	md5::sum digest( void ) const;
+	/// Returns the CRC32C checksum of all ingested messages.
+	///
+	/// @returns the checksum.
+	uint32_t crc( void ) const;
+};
+
+#endif
@@ -0,0 +1,382 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "md5.h"
+#include "md5_crypt.h"
+#include "md5_io.h"
+
+typedef uint8_t  u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+static constexpr u32 MAX_SALT_SIZE     = 8;    // Salts are truncated to this number of characters.
+static constexpr u32 ROUND_COUNT       = 1000; // The number of rounds of the algorithm.
+static constexpr u32 LAYOUT_COUNT      = 8;    // The number of distinct round message layouts.
+static constexpr u32 MAX_LANE_PASSWORD = 128;  // Passwords longer than this are not processed in lanes.
+static constexpr u32 LAYOUT_BYTESIZE   = ((DIGEST_BYTESIZE + MAX_LANE_PASSWORD * 2 + MAX_SALT_SIZE + 1 + sizeof(u64) + CHUNK_BYTESIZE - 1) / CHUNK_BYTESIZE) * CHUNK_BYTESIZE;
+
+static constexpr char ITOA64[] = "./0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+/// The parsed magic and salt of a setting.
+struct crypt_setting
+{
+	const char *magic;
+	u32         magic_size;
+	const char *salt;
+	u32         salt_size;
+
+	/// Parses the magic and salt from a setting.
+	///
+	/// @param setting the setting, or a complete hash.
+	///
+	/// @returns a boolean indicating true if the setting was recognized, and false otherwise.
+	bool parse(const char *setting)
+	{
+		if (strncmp(setting, "$1$", 3) == 0) {
+			magic = "$1$";
+		} else if (strncmp(setting, "$apr1$", 6) == 0) {
+			magic = "$apr1$";
+		} else {
+			return false;
+		}
+		magic_size = u32(strlen(magic));
+		salt = setting + magic_size;
+		salt_size = 0;
+		while (salt_size < MAX_SALT_SIZE && salt[salt_size] != 0 && salt[salt_size] != '$') {
+			++salt_size;
+		}
+		return true;
+	}
+};
+
+/// The state of one password through the rounds of md5-crypt. Each round hashes one of eight message layouts, depending on the round number. The layouts are padded in advance, so that each round only needs to copy in the digest of the previous round before compressing.
+struct crypt_lane
+{
+	u8  layouts[LAYOUT_COUNT][LAYOUT_BYTESIZE];
+	u32 digest_offset[LAYOUT_COUNT]; // Where the digest of the previous round goes in each layout.
+	u32 block_count[LAYOUT_COUNT];   // The number of blocks in each padded layout.
+	u32 state[4];
+	u8  digest[DIGEST_BYTESIZE];
+
+	/// Computes the initial digest and prepares the round layouts.
+	///
+	/// @param password the password.
+	/// @param password_size the number of characters in the password. Must not exceed MAX_LANE_PASSWORD.
+	/// @param setting the magic and salt.
+	void setup(const char *password, u32 password_size, const crypt_setting &setting)
+	{
+		initial_digest(password, password_size, setting, digest);
+		for (u32 layout = 0; layout < LAYOUT_COUNT; ++layout) {
+			const bool odd       = (layout & 1) != 0;
+			const bool with_salt = (layout & 2) != 0;
+			const bool with_pass = (layout & 4) != 0;
+
+			u8 *out = layouts[layout];
+			u32 size = 0;
+			if (odd) {
+				memcpy(out + size, password, password_size);
+				size += password_size;
+			} else {
+				digest_offset[layout] = size;
+				size += DIGEST_BYTESIZE;
+			}
+			if (with_salt) {
+				memcpy(out + size, setting.salt, setting.salt_size);
+				size += setting.salt_size;
+			}
+			if (with_pass) {
+				memcpy(out + size, password, password_size);
+				size += password_size;
+			}
+			if (odd) {
+				digest_offset[layout] = size;
+				size += DIGEST_BYTESIZE;
+			} else {
+				memcpy(out + size, password, password_size);
+				size += password_size;
+			}
+
+			const u64 message_bitsize = u64(size) * 8;
+			block_count[layout] = (size + 1 + sizeof(u64) + CHUNK_BYTESIZE - 1) / CHUNK_BYTESIZE;
+			const u32 padded_size = block_count[layout] * CHUNK_BYTESIZE;
+			out[size] = 0x80;
+			memset(out + size + 1, 0, padded_size - size - 1);
+			for (u32 i = 0; i < sizeof(u64); ++i) {
+				out[padded_size - sizeof(u64) + i] = u8(message_bitsize >> (i * 8));
+			}
+		}
+	}
+
+	/// Returns the layout used in a round.
+	///
+	/// @param round the round.
+	///
+	/// @returns the index of the layout.
+	static u32 layout_of(u32 round)
+	{
+		return (round & 1) | ((round % 3 != 0) ? 2 : 0) | ((round % 7 != 0) ? 4 : 0);
+	}
+
+	/// Computes the digest that the rounds start from.
+	///
+	/// @param password the password.
+	/// @param password_size the number of characters in the password.
+	/// @param setting the magic and salt.
+	/// @param out the destination digest.
+	static void initial_digest(const char *password, u32 password_size, const crypt_setting &setting, u8 *out)
+	{
+		md5 alt_ctx;
+		alt_ctx.ingest(password, password_size);
+		alt_ctx.ingest(setting.salt, setting.salt_size);
+		alt_ctx.ingest(password, password_size);
+		const md5::sum alt = alt_ctx.digest();
+
+		md5 ctx;
+		ctx.ingest(password, password_size);
+		ctx.ingest(setting.magic, setting.magic_size);
+		ctx.ingest(setting.salt, setting.salt_size);
+		for (u32 remaining = password_size; remaining > 0; remaining -= remaining < DIGEST_BYTESIZE ? remaining : DIGEST_BYTESIZE) {
+			ctx.ingest(static_cast<const u8*>(alt), remaining < DIGEST_BYTESIZE ? remaining : DIGEST_BYTESIZE);
+		}
+		for (u32 i = password_size; i > 0; i >>= 1) {
+			ctx.ingest((i & 1) ? "\0" : password, 1);
+		}
+		memcpy(out, static_cast<const u8*>(ctx.digest()), DIGEST_BYTESIZE);
+	}
+};
+
+/// Computes md5-crypt for passwords that are too long to be processed in lanes.
+///
+/// @param password the password.
+/// @param password_size the number of characters in the password.
+/// @param setting the magic and salt.
+/// @param out the destination digest.
+static void crypt_scalar(const char *password, u32 password_size, const crypt_setting &setting, u8 *out)
+{
+	crypt_lane::initial_digest(password, password_size, setting, out);
+	for (u32 round = 0; round < ROUND_COUNT; ++round) {
+		md5 ctx;
+		if (round & 1) {
+			ctx.ingest(password, password_size);
+		} else {
+			ctx.ingest(out, DIGEST_BYTESIZE);
+		}
+		if (round % 3 != 0) {
+			ctx.ingest(setting.salt, setting.salt_size);
+		}
+		if (round % 7 != 0) {
+			ctx.ingest(password, password_size);
+		}
+		if (round & 1) {
+			ctx.ingest(out, DIGEST_BYTESIZE);
+		} else {
+			ctx.ingest(password, password_size);
+		}
+		memcpy(out, static_cast<const u8*>(ctx.digest()), DIGEST_BYTESIZE);
+	}
+}
+
+/// Runs the rounds of several lanes in lock-step.
+///
+/// @param lanes the lanes.
+/// @param lane_count the number of lanes. Must not exceed MD5_LANES.
+static void crypt_rounds(crypt_lane *const *lanes, u32 lane_count)
+{
+	for (u32 round = 0; round < ROUND_COUNT; ++round) {
+		const u32 layout = crypt_lane::layout_of(round);
+		u32 max_blocks = 0;
+		for (u32 l = 0; l < lane_count; ++l) {
+			crypt_lane &lane = *lanes[l];
+			memcpy(lane.layouts[layout] + lane.digest_offset[layout], lane.digest, DIGEST_BYTESIZE);
+			md5_init(lane.state);
+			max_blocks = lane.block_count[layout] > max_blocks ? lane.block_count[layout] : max_blocks;
+		}
+		for (u32 block = 0; block < max_blocks; ++block) {
+			u32 *states[MD5_LANES];
+			const void *blocks[MD5_LANES];
+			u32 active_count = 0;
+			for (u32 l = 0; l < lane_count; ++l) {
+				crypt_lane &lane = *lanes[l];
+				if (block < lane.block_count[layout]) {
+					states[active_count] = lane.state;
+					blocks[active_count] = lane.layouts[layout] + block * CHUNK_BYTESIZE;
+					++active_count;
+				}
+			}
+			md5_compress_lanes(states, blocks, active_count);
+		}
+		for (u32 l = 0; l < lane_count; ++l) {
+			crypt_lane &lane = *lanes[l];
+			memcpy(lane.digest, static_cast<const u8*>(md5_state_sum(lane.state)), DIGEST_BYTESIZE);
+		}
+	}
+}
+
+/// Prints an md5-crypt hash.
+///
+/// @param setting the magic and salt.
+/// @param digest the final digest.
+/// @param out the destination of the zero-terminated hash.
+///
+/// @returns the pointer to the location in 'out' at which printing stopped.
+static char *sprint_crypt(const crypt_setting &setting, const u8 *digest, char *out)
+{
+	static constexpr u8 ORDER[5][3] = { { 0, 6, 12 }, { 1, 7, 13 }, { 2, 8, 14 }, { 3, 9, 15 }, { 4, 10, 5 } };
+	memcpy(out, setting.magic, setting.magic_size);
+	out += setting.magic_size;
+	memcpy(out, setting.salt, setting.salt_size);
+	out += setting.salt_size;
+	*out++ = '$';
+	for (u32 i = 0; i < 5; ++i) {
+		u32 v = (u32(digest[ORDER[i][0]]) << 16) | (u32(digest[ORDER[i][1]]) << 8) | u32(digest[ORDER[i][2]]);
+		for (u32 j = 0; j < 4; ++j, v >>= 6) {
+			*out++ = ITOA64[v & 0x3f];
+		}
+	}
+	u32 v = digest[11];
+	for (u32 j = 0; j < 2; ++j, v >>= 6) {
+		*out++ = ITOA64[v & 0x3f];
+	}
+	*out = 0;
+	return out;
+}
+
+/// Compares two zero-terminated strings in time independent of where they differ.
+///
+/// @param a the first string.
+/// @param b the second string.
+///
+/// @returns a boolean indicating true if the strings are equal, and false otherwise.
+static bool equal(const char *a, const char *b)
+{
+	const size_t a_size = strlen(a);
+	const size_t b_size = strlen(b);
+	if (a_size != b_size) {
+		return false;
+	}
+	u8 diff = 0;
+	for (size_t i = 0; i < a_size; ++i) {
+		diff |= u8(a[i] ^ b[i]);
+	}
+	return diff == 0;
+}
+
+/// Verifies a range of password and hash pairs, processing up to MD5_LANES pairs in lock-step.
+///
+/// @param passwords the zero-terminated passwords.
+/// @param hashes the zero-terminated hashes.
+/// @param results the destination of the result of each verification.
+/// @param count the number of pairs to verify.
+///
+/// @returns the number of passwords that matched their hash.
+static u64 verify_range(const char *const *passwords, const char *const *hashes, bool *results, u64 count)
+{
+	crypt_lane lanes[MD5_LANES];
+	crypt_setting settings[MD5_LANES];
+	u64 items[MD5_LANES];
+	u64 matches = 0;
+	u64 next = 0;
+	while (next < count) {
+		crypt_lane *active[MD5_LANES];
+		u32 lane_count = 0;
+		while (lane_count < MD5_LANES && next < count) {
+			const u64 item = next++;
+			crypt_setting &setting = settings[lane_count];
+			results[item] = false;
+			if (!setting.parse(hashes[item])) {
+				continue;
+			}
+			const size_t password_size = strlen(passwords[item]);
+			if (password_size > MAX_LANE_PASSWORD) {
+				u8 digest[DIGEST_BYTESIZE];
+				char hash[MD5_CRYPT_MAX_SIZE];
+				crypt_scalar(passwords[item], u32(password_size), setting, digest);
+				sprint_crypt(setting, digest, hash);
+				results[item] = equal(hash, hashes[item]);
+				matches += results[item] ? 1 : 0;
+				continue;
+			}
+			lanes[lane_count].setup(passwords[item], u32(password_size), setting);
+			active[lane_count] = &lanes[lane_count];
+			items[lane_count] = item;
+			++lane_count;
+		}
+		crypt_rounds(active, lane_count);
+		for (u32 l = 0; l < lane_count; ++l) {
+			char hash[MD5_CRYPT_MAX_SIZE];
+			sprint_crypt(settings[l], lanes[l].digest, hash);
+			results[items[l]] = equal(hash, hashes[items[l]]);
+			matches += results[items[l]] ? 1 : 0;
+		}
+	}
+	// Clear sensitive data.
+	memset(lanes, 0, sizeof(lanes));
+	return matches;
+}
+
+char *md5_crypt(const char *password, const char *setting, char *out)
+{
+	crypt_setting s;
+	if (!s.parse(setting)) {
+		return nullptr;
+	}
+	const size_t password_size = strlen(password);
+	u8 digest[DIGEST_BYTESIZE];
+	if (password_size > MAX_LANE_PASSWORD) {
+		crypt_scalar(password, u32(password_size), s, digest);
+	} else {
+		crypt_lane lane;
+		crypt_lane *lanes[1] = { &lane };
+		lane.setup(password, u32(password_size), s);
+		crypt_rounds(lanes, 1);
+		memcpy(digest, lane.digest, DIGEST_BYTESIZE);
+		memset(&lane, 0, sizeof(lane)); // Clear sensitive data.
+	}
+	return sprint_crypt(s, digest, out);
+}
+
+bool md5_crypt_verify(const char *password, const char *hash)
+{
+	char out[MD5_CRYPT_MAX_SIZE];
+	return md5_crypt(password, hash, out) != nullptr && equal(out, hash);
+}
+
+u64 md5_crypt_verify(const char *const *passwords, const char *const *hashes, bool *results, u64 count, u32 thread_count)
+{
+	if (thread_count == 0) {
+		thread_count = std::thread::hardware_concurrency();
+	}
+	if (thread_count <= 1 || count <= MD5_LANES) {
+		return verify_range(passwords, hashes, results, count);
+	}
+
+	// Split the pairs in multiples of MD5_LANES so that the lanes of each thread are kept full.
+	const u64 lane_groups = (count + MD5_LANES - 1) / MD5_LANES;
+	const u64 per_thread = (lane_groups + thread_count - 1) / thread_count * MD5_LANES;
+
+	std::vector<std::thread> threads;
+	std::vector<u64> matches(thread_count, 0);
+	for (u32 t = 0; t < thread_count && u64(t) * per_thread < count; ++t) {
+		const u64 begin = u64(t) * per_thread;
+		const u64 n = (count - begin) < per_thread ? (count - begin) : per_thread;
+		threads.emplace_back([=, &matches]() {
+			matches[t] = verify_range(passwords + begin, hashes + begin, results + begin, n);
+		});
+	}
+	u64 total = 0;
+	for (u32 t = 0; t < threads.size(); ++t) {
+		threads[t].join();
+		total += matches[t];
+	}
+	return total;
+}
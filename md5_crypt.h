@@ -0,0 +1,47 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_CRYPT_H_INCLUDED__
+#define MD5_CRYPT_H_INCLUDED__
+
+#include <cstdint>
+
+/// The maximum number of characters in an md5-crypt hash, including the zero-terminator.
+constexpr uint32_t MD5_CRYPT_MAX_SIZE = 38;
+
+/// Computes the md5-crypt password hash ('$1$', as used by crypt(3), or '$apr1$', as used by Apache).
+///
+/// @param password the zero-terminated password.
+/// @param setting the magic and salt, such as '$1$salt' or '$apr1$salt'. A complete hash is also accepted, in which case its magic and salt are used.
+/// @param out the destination of the zero-terminated hash. Must fit at least MD5_CRYPT_MAX_SIZE characters.
+///
+/// @returns the pointer to the location in 'out' at which printing stopped, or nullptr if the setting is not recognized.
+char *md5_crypt(const char *password, const char *setting, char *out);
+
+/// Verifies a password against an md5-crypt hash.
+///
+/// @param password the zero-terminated password.
+/// @param hash the zero-terminated hash, such as '$1$salt$checksum' or '$apr1$salt$checksum'.
+///
+/// @returns a boolean indicating true if the password matches the hash, and false otherwise.
+bool md5_crypt_verify(const char *password, const char *hash);
+
+/// Verifies several passwords against md5-crypt hashes. Each password is paired with the hash at the same index. The 1000 rounds of up to MD5_LANES pairs are processed in lock-step, and the pairs are split over several threads.
+///
+/// @param passwords the zero-terminated passwords.
+/// @param hashes the zero-terminated hashes.
+/// @param results the destination of the result of each verification.
+/// @param count the number of pairs to verify.
+/// @param thread_count the number of threads to use. Zero uses the number of hardware threads.
+///
+/// @returns the number of passwords that matched their hash.
+uint64_t md5_crypt_verify(const char *const *passwords, const char *const *hashes, bool *results, uint64_t count, uint32_t thread_count = 0);
+
+#endif
@@ -0,0 +1,455 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include "md5_delta.h"
+#include "md5_io.h"
+
+typedef uint8_t  u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+static constexpr u32 READ_BLOCKS       = 256;     // The number of blocks read from a file at a time.
+static constexpr u64 COPY_BYTESIZE     = 1 << 20; // The number of bytes copied from a basis file at a time.
+static constexpr u64 TAG_COUNT         = 1 << 16;
+static constexpr char SIGNATURE_MAGIC[8] = { 'M', 'D', '5', 'S', 'I', 'G', 'N', '1' };
+static constexpr char DELTA_MAGIC[8]     = { 'M', 'D', '5', 'D', 'E', 'L', 'T', 'A' };
+
+/// Returns the 16-bit tag of a weak checksum.
+///
+/// @param weak the weak checksum.
+///
+/// @returns the tag.
+static u32 tag_of(u32 weak)
+{
+	return (weak ^ (weak >> 16)) & 0xffff;
+}
+
+/// Reads a whole file into memory.
+///
+/// @param path the path of the file.
+/// @param out the destination of the contents of the file.
+///
+/// @returns a boolean indicating true if the file could be read, and false otherwise.
+static bool read_file(const char *path, std::vector<u8> &out)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file) {
+		return false;
+	}
+	out.resize(size_t(file.tellg()));
+	file.seekg(0);
+	return out.empty() || bool(file.read(reinterpret_cast<char*>(out.data()), std::streamsize(out.size())));
+}
+
+void md5_signature::index( void )
+{
+	m_index.resize(m_weak.size());
+	for (size_t i = 0; i < m_weak.size(); ++i) {
+		m_index[i] = (u64(m_weak[i]) << 32) | u64(i);
+	}
+	std::sort(m_index.begin(), m_index.end());
+	m_tags.assign(TAG_COUNT / 64, 0);
+	for (size_t i = 0; i < m_weak.size(); ++i) {
+		const u32 tag = tag_of(m_weak[i]);
+		m_tags[tag / 64] |= u64(1) << (tag % 64);
+	}
+}
+
+md5_signature::md5_signature( void ) : m_weak(), m_strong(), m_index(), m_tags(), m_basis_size(0), m_block_size(MD5_DELTA_BLOCK_SIZE)
+{}
+
+void md5_signature::build(const void *basis, u64 byte_count, u32 block_size)
+{
+	const u8 *bytes = reinterpret_cast<const u8*>(basis);
+	m_block_size = block_size < 1 ? 1 : block_size;
+	m_basis_size = byte_count;
+	const u64 block_count = (byte_count + m_block_size - 1) / m_block_size;
+	m_weak.resize(size_t(block_count));
+	m_strong.resize(size_t(block_count));
+
+	std::vector<const void*> blocks(static_cast<size_t>(block_count));
+	std::vector<u64> sizes(static_cast<size_t>(block_count));
+	for (u64 i = 0; i < block_count; ++i) {
+		blocks[i] = bytes + i * m_block_size;
+		sizes[i] = (byte_count - i * m_block_size) < m_block_size ? (byte_count - i * m_block_size) : m_block_size;
+		m_weak[i] = weak_sum(blocks[i], sizes[i]);
+	}
+	md5_batch(blocks.data(), sizes.data(), m_strong.data(), block_count);
+	index();
+}
+
+bool md5_signature::build_file(const char *path, u32 block_size)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	block_size = block_size < 1 ? 1 : block_size;
+	std::vector<u32> weak;
+	std::vector<md5::sum> strong;
+	std::vector<char> buffer(size_t(u64(block_size) * READ_BLOCKS));
+	const void *blocks[READ_BLOCKS];
+	u64 sizes[READ_BLOCKS];
+	u64 basis_size = 0;
+	while (file) {
+		file.read(buffer.data(), std::streamsize(buffer.size()));
+		const u64 read_size = u64(file.gcount());
+		if (read_size == 0) {
+			break;
+		}
+		const u32 block_count = u32((read_size + block_size - 1) / block_size);
+		for (u32 i = 0; i < block_count; ++i) {
+			blocks[i] = buffer.data() + u64(i) * block_size;
+			sizes[i] = (read_size - u64(i) * block_size) < block_size ? (read_size - u64(i) * block_size) : block_size;
+			weak.push_back(weak_sum(blocks[i], sizes[i]));
+		}
+		strong.resize(weak.size());
+		md5_batch(blocks, sizes, strong.data() + strong.size() - block_count, block_count);
+		basis_size += read_size;
+	}
+	if (file.bad()) {
+		return false;
+	}
+	m_weak.swap(weak);
+	m_strong.swap(strong);
+	m_basis_size = basis_size;
+	m_block_size = block_size;
+	index();
+	return true;
+}
+
+bool md5_signature::find(u32 weak, const u8 *window, u32 size, u64 hint, u64 &block) const
+{
+	const u32 tag = tag_of(weak);
+	if (m_tags.empty() || (m_tags[tag / 64] & (u64(1) << (tag % 64))) == 0) {
+		return false;
+	}
+	auto candidate = std::lower_bound(m_index.begin(), m_index.end(), u64(weak) << 32);
+	if (candidate == m_index.end() || (*candidate >> 32) != weak) {
+		return false;
+	}
+
+	// Only windows that pass the weak checksum are digested.
+	const md5::sum strong = md5(window, size).digest();
+	const u64 last = m_weak.size() - 1;
+	const u32 last_size = u32(m_basis_size - last * m_block_size);
+	if (hint < m_weak.size() && m_weak[hint] == weak && (hint < last ? m_block_size : last_size) == size && m_strong[hint] == strong) {
+		block = hint;
+		return true;
+	}
+	for (; candidate != m_index.end() && (*candidate >> 32) == weak; ++candidate) {
+		const u64 i = *candidate & 0xffffffff;
+		if ((i < last ? m_block_size : last_size) == size && m_strong[i] == strong) {
+			block = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+u32 md5_signature::block_size( void ) const
+{
+	return m_block_size;
+}
+
+u64 md5_signature::block_count( void ) const
+{
+	return m_weak.size();
+}
+
+u64 md5_signature::basis_size( void ) const
+{
+	return m_basis_size;
+}
+
+bool md5_signature::save(const char *path) const
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file.write(SIGNATURE_MAGIC, sizeof(SIGNATURE_MAGIC)) || !write_le<u64>(file, m_block_size) || !write_le<u64>(file, m_basis_size)) {
+		return false;
+	}
+	for (size_t i = 0; i < m_weak.size(); ++i) {
+		if (!write_le<u64>(file, m_weak[i]) || !file.write(reinterpret_cast<const char*>(static_cast<const u8*>(m_strong[i])), sizeof(md5::sum))) {
+			return false;
+		}
+	}
+	return bool(file.flush());
+}
+
+bool md5_signature::load(const char *path)
+{
+	std::ifstream file(path, std::ios::binary);
+	char magic[sizeof(SIGNATURE_MAGIC)];
+	u64 block_size, basis_size;
+	if (!file.read(magic, sizeof(magic)) || memcmp(magic, SIGNATURE_MAGIC, sizeof(magic)) != 0 || !read_le<u64>(file, block_size) || !read_le<u64>(file, basis_size) || block_size < 1 || block_size > 0xffffffff) {
+		return false;
+	}
+	const u64 block_count = (basis_size + block_size - 1) / block_size;
+	std::vector<u32> weak;
+	std::vector<md5::sum> strong;
+	for (u64 i = 0; i < block_count; ++i) {
+		u64 w;
+		u8 digest[sizeof(md5::sum)];
+		if (!read_le<u64>(file, w) || w > 0xffffffff || !file.read(reinterpret_cast<char*>(digest), sizeof(digest))) {
+			return false;
+		}
+		weak.push_back(u32(w));
+		strong.push_back(md5::sum());
+		memcpy(static_cast<u8*>(strong.back()), digest, sizeof(digest));
+	}
+	m_weak.swap(weak);
+	m_strong.swap(strong);
+	m_basis_size = basis_size;
+	m_block_size = u32(block_size);
+	index();
+	return true;
+}
+
+u32 md5_signature::weak_sum(const void *data, u64 byte_count)
+{
+	const u8 *bytes = reinterpret_cast<const u8*>(data);
+	u32 a = 0;
+	u32 b = 0;
+	for (u64 i = 0; i < byte_count; ++i) {
+		a += bytes[i];
+		b += u32(byte_count - i) * bytes[i];
+	}
+	return (a & 0xffff) | (b << 16);
+}
+
+void md5_delta::append(const md5_delta_op &op)
+{
+	if (!m_ops.empty() && m_ops.back().literal == op.literal && m_ops.back().offset + m_ops.back().size == op.offset) {
+		m_ops.back().size += op.size;
+	} else {
+		m_ops.push_back(op);
+	}
+}
+
+md5_delta::md5_delta( void ) : m_ops(), m_literals(), m_target_size(0), m_target_sum(md5().digest())
+{}
+
+void md5_delta::compute(const md5_signature &signature, const void *target, u64 byte_count)
+{
+	const u8 *bytes = reinterpret_cast<const u8*>(target);
+	const u32 block_size = signature.block_size();
+	m_ops.clear();
+	m_literals.clear();
+	m_target_size = byte_count;
+	m_target_sum = md5(target, byte_count).digest();
+
+	u64 literal_start = 0;
+	auto emit_literal = [&](u64 end) {
+		if (end > literal_start) {
+			const md5_delta_op op = { m_literals.size(), end - literal_start, true };
+			append(op);
+			m_literals.insert(m_literals.end(), bytes + literal_start, bytes + end);
+		}
+	};
+
+	if (signature.block_count() > 0 && byte_count >= block_size) {
+		// The weak checksum is rolled one byte at a time, and restarted after each matched block.
+		u64 pos = 0;
+		u64 hint = 0;
+		u32 a = 0;
+		u32 b = 0;
+		for (u32 i = 0; i < block_size; ++i) {
+			a += bytes[i];
+			b += (block_size - i) * bytes[i];
+		}
+		for (;;) {
+			u64 block;
+			if (signature.find((a & 0xffff) | (b << 16), bytes + pos, block_size, hint, block)) {
+				emit_literal(pos);
+				const md5_delta_op op = { block * block_size, block_size, false };
+				append(op);
+				hint = block + 1;
+				pos += block_size;
+				literal_start = pos;
+				if (pos + block_size > byte_count) {
+					break;
+				}
+				a = b = 0;
+				for (u32 i = 0; i < block_size; ++i) {
+					a += bytes[pos + i];
+					b += (block_size - i) * bytes[pos + i];
+				}
+			} else {
+				if (pos + block_size >= byte_count) {
+					break;
+				}
+				a += bytes[pos + block_size] - bytes[pos];
+				b += a - block_size * bytes[pos];
+				++pos;
+			}
+		}
+	}
+
+	// The last block of the basis may be shorter than the others, and can only match the end of the target.
+	const u64 last_size = signature.block_count() > 0 ? signature.basis_size() - (signature.block_count() - 1) * block_size : 0;
+	if (last_size > 0 && last_size < block_size && byte_count - literal_start >= last_size) {
+		const u8 *window = bytes + byte_count - last_size;
+		u64 block;
+		if (signature.find(md5_signature::weak_sum(window, last_size), window, u32(last_size), signature.block_count() - 1, block)) {
+			emit_literal(byte_count - last_size);
+			const md5_delta_op op = { block * block_size, last_size, false };
+			append(op);
+			literal_start = byte_count;
+		}
+	}
+	emit_literal(byte_count);
+}
+
+bool md5_delta::compute_file(const md5_signature &signature, const char *path)
+{
+	std::vector<u8> target;
+	if (!read_file(path, target)) {
+		return false;
+	}
+	compute(signature, target.data(), target.size());
+	return true;
+}
+
+bool md5_delta::apply(const void *basis, u64 byte_count, std::vector<u8> &out) const
+{
+	const u8 *bytes = reinterpret_cast<const u8*>(basis);
+	out.clear();
+	out.reserve(size_t(m_target_size));
+	for (size_t i = 0; i < m_ops.size(); ++i) {
+		const md5_delta_op &op = m_ops[i];
+		const u64 source_size = op.literal ? m_literals.size() : byte_count;
+		if (op.offset > source_size || op.size > source_size - op.offset) {
+			return false;
+		}
+		const u8 *source = op.literal ? m_literals.data() : bytes;
+		out.insert(out.end(), source + op.offset, source + op.offset + op.size);
+	}
+	return out.size() == m_target_size && md5(out.data(), out.size()).digest() == m_target_sum;
+}
+
+bool md5_delta::apply_file(const char *basis_path, const char *out_path) const
+{
+	std::ifstream basis(basis_path, std::ios::binary);
+	std::ofstream out(out_path, std::ios::binary);
+	if (!basis || !out) {
+		return false;
+	}
+	std::vector<char> buffer;
+	md5 ctx;
+	u64 size = 0;
+	for (size_t i = 0; i < m_ops.size(); ++i) {
+		const md5_delta_op &op = m_ops[i];
+		if (op.literal) {
+			if (op.offset > m_literals.size() || op.size > m_literals.size() - op.offset) {
+				return false;
+			}
+			const char *literals = reinterpret_cast<const char*>(m_literals.data()) + op.offset;
+			if (!out.write(literals, std::streamsize(op.size))) {
+				return false;
+			}
+			ctx(literals, op.size);
+		} else {
+			if (!basis.seekg(std::streamoff(op.offset))) {
+				return false;
+			}
+			for (u64 remaining = op.size; remaining > 0;) {
+				const u64 copy_size = remaining < COPY_BYTESIZE ? remaining : COPY_BYTESIZE;
+				buffer.resize(size_t(copy_size));
+				if (!basis.read(buffer.data(), std::streamsize(copy_size)) || !out.write(buffer.data(), std::streamsize(copy_size))) {
+					return false;
+				}
+				ctx(buffer.data(), copy_size);
+				remaining -= copy_size;
+			}
+		}
+		size += op.size;
+	}
+	return bool(out.flush()) && size == m_target_size && ctx.digest() == m_target_sum;
+}
+
+const std::vector<md5_delta_op> &md5_delta::ops( void ) const
+{
+	return m_ops;
+}
+
+u64 md5_delta::literal_size( void ) const
+{
+	return m_literals.size();
+}
+
+u64 md5_delta::target_size( void ) const
+{
+	return m_target_size;
+}
+
+bool md5_delta::save(const char *path) const
+{
+	std::ofstream file(path, std::ios::binary);
+	if (
+		!file.write(DELTA_MAGIC, sizeof(DELTA_MAGIC)) ||
+		!write_le<u64>(file, m_target_size) ||
+		!file.write(reinterpret_cast<const char*>(static_cast<const u8*>(m_target_sum)), sizeof(md5::sum)) ||
+		!write_le<u64>(file, m_ops.size()) ||
+		!write_le<u64>(file, m_literals.size())
+	) {
+		return false;
+	}
+	for (size_t i = 0; i < m_ops.size(); ++i) {
+		// The literal flag is stored in the most significant bit of the size.
+		if (!write_le<u64>(file, m_ops[i].offset) || !write_le<u64>(file, m_ops[i].size | (m_ops[i].literal ? (u64(1) << 63) : 0))) {
+			return false;
+		}
+	}
+	return bool(file.write(reinterpret_cast<const char*>(m_literals.data()), std::streamsize(m_literals.size()))) && bool(file.flush());
+}
+
+bool md5_delta::load(const char *path)
+{
+	std::ifstream file(path, std::ios::binary);
+	char magic[sizeof(DELTA_MAGIC)];
+	u8 digest[sizeof(md5::sum)];
+	u64 target_size, op_count, literal_size;
+	if (
+		!file.read(magic, sizeof(magic)) || memcmp(magic, DELTA_MAGIC, sizeof(magic)) != 0 ||
+		!read_le<u64>(file, target_size) ||
+		!file.read(reinterpret_cast<char*>(digest), sizeof(digest)) ||
+		!read_le<u64>(file, op_count) ||
+		!read_le<u64>(file, literal_size)
+	) {
+		return false;
+	}
+	std::vector<md5_delta_op> ops;
+	for (u64 i = 0; i < op_count; ++i) {
+		md5_delta_op op;
+		if (!read_le<u64>(file, op.offset) || !read_le<u64>(file, op.size)) {
+			return false;
+		}
+		op.literal = (op.size >> 63) != 0;
+		op.size &= ~(u64(1) << 63);
+		ops.push_back(op);
+	}
+	std::vector<u8> literals;
+	for (u64 remaining = literal_size; remaining > 0;) { // Grown while reading, so that a corrupt size does not allocate before failing.
+		const u64 read_size = remaining < COPY_BYTESIZE ? remaining : COPY_BYTESIZE;
+		literals.resize(size_t(literals.size() + read_size));
+		if (!file.read(reinterpret_cast<char*>(literals.data() + literals.size() - read_size), std::streamsize(read_size))) {
+			return false;
+		}
+		remaining -= read_size;
+	}
+	m_ops.swap(ops);
+	m_literals.swap(literals);
+	m_target_size = target_size;
+	memcpy(static_cast<u8*>(m_target_sum), digest, sizeof(digest));
+	return true;
+}
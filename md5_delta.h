@@ -0,0 +1,184 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_DELTA_H_INCLUDED__
+#define MD5_DELTA_H_INCLUDED__
+
+#include <cstdint>
+#include <vector>
+#include "md5.h"
+
+/// The default number of bytes in each block of a signature.
+constexpr uint32_t MD5_DELTA_BLOCK_SIZE = 2048;
+
+/// The block signatures of a basis file, used to compute a delta against it. Each fixed-size block has an rsync-style weak rolling checksum and an MD5 digest.
+class md5_signature
+{
+private:
+	std::vector<uint32_t> m_weak;       // The weak checksum of each block.
+	std::vector<md5::sum> m_strong;     // The digest of each block.
+	std::vector<uint64_t> m_index;      // Weak checksums paired with block indices, sorted.
+	std::vector<uint64_t> m_tags;       // A bit for each 16-bit tag of a weak checksum, for rejecting most positions without searching.
+	uint64_t              m_basis_size;
+	uint32_t              m_block_size;
+
+private:
+	/// Builds the lookup structures from the block checksums.
+	void index( void );
+
+public:
+	/// Creates an empty signature.
+	md5_signature( void );
+
+	/// Computes the signature of a basis. Blocks are digested in lock-step with 'md5_batch'.
+	///
+	/// @param basis the basis.
+	/// @param byte_count the number of bytes in the basis.
+	/// @param block_size the number of bytes in each block. At least 1.
+	void build(const void *basis, uint64_t byte_count, uint32_t block_size = MD5_DELTA_BLOCK_SIZE);
+	/// Computes the signature of a basis file. The file is read a few blocks at a time.
+	///
+	/// @param path the path of the basis file.
+	/// @param block_size the number of bytes in each block. At least 1.
+	///
+	/// @returns a boolean indicating true if the file could be read, and false otherwise.
+	bool build_file(const char *path, uint32_t block_size = MD5_DELTA_BLOCK_SIZE);
+
+	/// Finds a block of the basis matching a window of bytes.
+	///
+	/// @param weak the weak checksum of the window.
+	/// @param window the window.
+	/// @param size the number of bytes in the window.
+	/// @param hint the block to prefer if several blocks match, typically the one after the last matched block.
+	/// @param block the destination index of the matching block.
+	///
+	/// @returns a boolean indicating true if a block matches, and false otherwise. The window is only digested if its weak checksum matches a block.
+	bool find(uint32_t weak, const uint8_t *window, uint32_t size, uint64_t hint, uint64_t &block) const;
+
+	/// Returns the number of bytes in each block.
+	///
+	/// @returns the block size.
+	uint32_t block_size( void ) const;
+	/// Returns the number of blocks. The last block may be shorter than the block size.
+	///
+	/// @returns the number of blocks.
+	uint64_t block_count( void ) const;
+	/// Returns the number of bytes in the basis.
+	///
+	/// @returns the basis size.
+	uint64_t basis_size( void ) const;
+
+	/// Writes the signature to a file.
+	///
+	/// @param path the path of the file.
+	///
+	/// @returns a boolean indicating true if the file was written, and false otherwise.
+	bool save(const char *path) const;
+	/// Replaces the signature with one read from a file.
+	///
+	/// @param path the path of the file.
+	///
+	/// @returns a boolean indicating true if the file contained a valid signature, and false otherwise, in which case the signature is left unchanged.
+	bool load(const char *path);
+
+	/// Computes the weak rolling checksum of a sequence of bytes, as used by rsync.
+	///
+	/// @param data the bytes.
+	/// @param byte_count the number of bytes.
+	///
+	/// @returns the checksum.
+	static uint32_t weak_sum(const void *data, uint64_t byte_count);
+};
+
+/// An instruction of a delta.
+struct md5_delta_op
+{
+	uint64_t offset;  // The offset of the bytes in the basis if copying, or in the literals of the delta otherwise.
+	uint64_t size;    // The number of bytes.
+	bool     literal; // True if the bytes are literals stored in the delta, and false if they are copied from the basis.
+};
+
+/// The instructions that reconstruct a target from a basis, using the bytes of the target that are not found in the basis.
+class md5_delta
+{
+private:
+	std::vector<md5_delta_op> m_ops;
+	std::vector<uint8_t>      m_literals;
+	uint64_t                  m_target_size;
+	md5::sum                  m_target_sum;
+
+private:
+	/// Appends an instruction, merging it with the previous instruction if they are contiguous.
+	///
+	/// @param op the instruction.
+	void append(const md5_delta_op &op);
+
+public:
+	/// Creates an empty delta.
+	md5_delta( void );
+
+	/// Computes the delta of a target against a basis. Blocks are matched at any offset in the target by rolling the weak checksum a byte at a time, and confirmed by their digests.
+	///
+	/// @param signature the signature of the basis.
+	/// @param target the target.
+	/// @param byte_count the number of bytes in the target.
+	void compute(const md5_signature &signature, const void *target, uint64_t byte_count);
+	/// Computes the delta of a target file against a basis. The target file is read into memory.
+	///
+	/// @param signature the signature of the basis.
+	/// @param path the path of the target file.
+	///
+	/// @returns a boolean indicating true if the file could be read, and false otherwise.
+	bool compute_file(const md5_signature &signature, const char *path);
+
+	/// Reconstructs the target.
+	///
+	/// @param basis the basis.
+	/// @param byte_count the number of bytes in the basis.
+	/// @param out the destination of the target.
+	///
+	/// @returns a boolean indicating true if the reconstructed target has the size and digest of the original target, and false otherwise.
+	bool apply(const void *basis, uint64_t byte_count, std::vector<uint8_t> &out) const;
+	/// Reconstructs the target from a basis file to a file.
+	///
+	/// @param basis_path the path of the basis file.
+	/// @param out_path the path of the reconstructed target. Must differ from 'basis_path'.
+	///
+	/// @returns a boolean indicating true if the reconstructed target has the size and digest of the original target, and false otherwise.
+	bool apply_file(const char *basis_path, const char *out_path) const;
+
+	/// Returns the instructions.
+	///
+	/// @returns the instructions.
+	const std::vector<md5_delta_op> &ops( void ) const;
+	/// Returns the number of literal bytes, which is the number of target bytes not found in the basis.
+	///
+	/// @returns the number of literal bytes.
+	uint64_t literal_size( void ) const;
+	/// Returns the number of bytes in the target.
+	///
+	/// @returns the target size.
+	uint64_t target_size( void ) const;
+
+	/// Writes the delta to a file.
+	///
+	/// @param path the path of the file.
+	///
+	/// @returns a boolean indicating true if the file was written, and false otherwise.
+	bool save(const char *path) const;
+	/// Replaces the delta with one read from a file.
+	///
+	/// @param path the path of the file.
+	///
+	/// @returns a boolean indicating true if the file contained a valid delta, and false otherwise, in which case the delta is left unchanged.
+	bool load(const char *path);
+};
+
+#endif
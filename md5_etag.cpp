@@ -0,0 +1,86 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#include "md5_etag.h"
+#include "md5_io.h"
+#include "md5_parallel.h"
+
+typedef uint8_t  u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+void md5_etag::combine( void )
+{
+	md5 ctx;
+	for (const md5::sum &part : m_parts) {
+		ctx.ingest(static_cast<const u8*>(part), DIGEST_BYTESIZE);
+	}
+	m_sum = ctx.digest();
+}
+
+md5_etag::md5_etag( void ) : m_parts(1, md5().digest())
+{
+	combine();
+}
+
+md5_etag::md5_etag(const void *message, u64 byte_count, u64 part_size, u32 thread_count) : m_parts(size_t(md5_part_count(byte_count, part_size)))
+{
+	md5_parts(message, byte_count, part_size, m_parts.data(), thread_count);
+	combine();
+}
+
+bool md5_etag::from_file(const char *path, u64 part_size, u32 thread_count)
+{
+	std::vector<md5::sum> parts;
+	if (!md5_parts_file(path, part_size, parts, thread_count)) {
+		return false;
+	}
+	m_parts.swap(parts);
+	combine();
+	return true;
+}
+
+const md5::sum &md5_etag::digest( void ) const
+{
+	return m_sum;
+}
+
+u64 md5_etag::part_count( void ) const
+{
+	return u64(m_parts.size());
+}
+
+const md5::sum *md5_etag::parts( void ) const
+{
+	return m_parts.data();
+}
+
+char *md5_etag::sprint(char *out) const
+{
+	out = m_sum.sprint_hex(out);
+	*out++ = '-';
+	char digits[20];
+	u32 digit_count = 0;
+	u64 n = part_count();
+	do {
+		digits[digit_count++] = char('0' + n % 10);
+		n /= 10;
+	} while (n > 0);
+	while (digit_count > 0) {
+		*out++ = digits[--digit_count];
+	}
+	return out;
+}
+
+std::string md5_etag::str( void ) const
+{
+	char out[DIGEST_BYTESIZE * 2 + 1 + 20];
+	return std::string(out, sprint(out));
+}
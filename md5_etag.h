@@ -0,0 +1,75 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_ETAG_H_INCLUDED__
+#define MD5_ETAG_H_INCLUDED__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "md5.h"
+
+/// Computes S3-compatible multipart upload ETags. The ETag of a multipart object is the MD5 digest of the concatenated binary digests of its parts, followed by a dash and the number of parts. The parts are processed concurrently with 'md5_parts'.
+class md5_etag
+{
+private:
+	md5::sum              m_sum;
+	std::vector<md5::sum> m_parts;
+
+private:
+	/// Computes the digest of the concatenated part digests.
+	void combine( void );
+
+public:
+	/// Default constructor. The ETag of an empty object uploaded as a single part.
+	md5_etag( void );
+	/// Computes the ETag of a message in memory.
+	///
+	/// @param message the message.
+	/// @param byte_count the number of bytes in the message.
+	/// @param part_size the number of bytes in each part. The last part may be shorter.
+	/// @param thread_count the number of threads to use. Zero uses the number of hardware threads.
+	md5_etag(const void *message, uint64_t byte_count, uint64_t part_size, uint32_t thread_count = 0);
+
+	/// Computes the ETag of a file.
+	///
+	/// @param path the path of the file.
+	/// @param part_size the number of bytes in each part. The last part may be shorter.
+	/// @param thread_count the number of threads to use. Zero uses the number of hardware threads.
+	///
+	/// @returns a boolean indicating true if the file could be read in full, and false otherwise. The ETag is left unmodified on failure.
+	bool from_file(const char *path, uint64_t part_size, uint32_t thread_count = 0);
+
+	/// Returns the digest of the concatenated part digests.
+	///
+	/// @returns the digest.
+	const md5::sum &digest( void ) const;
+	/// Returns the number of parts.
+	///
+	/// @returns the number of parts.
+	uint64_t part_count( void ) const;
+	/// Returns the digests of the parts.
+	///
+	/// @returns the array of 'part_count' part digests.
+	const md5::sum *parts( void ) const;
+
+	/// Prints the ETag, such as '9b2cf535f27731c974343645a3985328-3', to a string.
+	///
+	/// @param out the destination of the print.
+	///
+	/// @returns the pointer to the location in the sprint at which printing stopped.
+	char *sprint(char *out) const;
+	/// Returns the ETag, such as '9b2cf535f27731c974343645a3985328-3'.
+	///
+	/// @returns the ETag.
+	std::string str( void ) const;
+};
+
+#endif
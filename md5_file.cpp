@@ -0,0 +1,215 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#if defined(__unix__) || defined(__APPLE__)
+	#include <unistd.h>
+#endif
+#include "md5_file.h"
+#include "md5_io.h"
+
+typedef uint8_t  u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+static constexpr u64  READ_BYTESIZE       = 1 << 20; // The number of bytes read from a file at a time.
+static constexpr char CHECKPOINT_MAGIC[8] = { 'M', 'D', '5', 'C', 'K', 'P', 'T', '2' };
+
+/// The identity of a file. A checkpoint only applies to the file it was taken of, and only if the file has not been modified since.
+struct identity
+{
+	u64 device;
+	u64 inode;
+	u64 size;
+	u64 mtime; // In nanoseconds where the platform provides them, so that modifications within the same second are detected.
+};
+
+/// Reads the identity of a file.
+///
+/// @param path the path of the file.
+/// @param out the destination identity.
+///
+/// @returns a boolean indicating true if the file exists, and false otherwise.
+static bool identify(const char *path, identity &out)
+{
+	struct stat info;
+	if (stat(path, &info) != 0) {
+		return false;
+	}
+	out.device = u64(info.st_dev);
+	out.inode = u64(info.st_ino);
+	out.size = u64(info.st_size);
+#if defined(__APPLE__)
+	out.mtime = u64(info.st_mtimespec.tv_sec) * 1000000000 + u64(info.st_mtimespec.tv_nsec);
+#elif defined(__unix__)
+	out.mtime = u64(info.st_mtim.tv_sec) * 1000000000 + u64(info.st_mtim.tv_nsec);
+#else
+	out.mtime = u64(info.st_mtime);
+#endif
+	return true;
+}
+
+/// Writes a checkpoint. The checkpoint is written to a temporary file which then replaces the checkpoint file, so that an interruption never leaves a partially written checkpoint behind.
+///
+/// @param path the path of the checkpoint file.
+/// @param file the identity of the digested file.
+/// @param state the intermediate state of the digest.
+///
+/// @returns a boolean indicating true if the checkpoint was written, and false otherwise.
+static bool save_checkpoint(const char *path, const identity &file, const md5::snapshot &state)
+{
+	std::vector<u8> record(CHECKPOINT_MAGIC, CHECKPOINT_MAGIC + sizeof(CHECKPOINT_MAGIC));
+	append_le<u64>(record, file.device);
+	append_le<u64>(record, file.inode);
+	append_le<u64>(record, file.size);
+	append_le<u64>(record, file.mtime);
+	append_le<u64>(record, state.message_size);
+	for (u32 i = 0; i < 4; ++i) {
+		append_le<u32>(record, state.state[i]);
+	}
+	record.insert(record.end(), state.chunk, state.chunk + state.chunk_size);
+	const md5::sum check = md5(record.data(), record.size()).digest(); // Detects corrupt checkpoints.
+	record.insert(record.end(), static_cast<const u8*>(check), static_cast<const u8*>(check) + DIGEST_BYTESIZE);
+
+	const std::string temp_path = std::string(path) + ".tmp";
+	FILE *out = fopen(temp_path.c_str(), "wb");
+	if (out == nullptr) {
+		return false;
+	}
+	bool success = fwrite(record.data(), 1, record.size(), out) == record.size() && fflush(out) == 0;
+#if defined(__unix__) || defined(__APPLE__)
+	success = success && fsync(fileno(out)) == 0;
+#endif
+	success = (fclose(out) == 0) && success;
+	if (success && rename(temp_path.c_str(), path) != 0) {
+		// Some platforms do not replace existing files when renaming.
+		remove(path);
+		success = rename(temp_path.c_str(), path) == 0;
+	}
+	if (!success) {
+		remove(temp_path.c_str());
+	}
+	return success;
+}
+
+/// Reads a checkpoint.
+///
+/// @param path the path of the checkpoint file.
+/// @param file the identity of the file to be digested.
+/// @param state the destination intermediate state of the digest.
+///
+/// @returns a boolean indicating true if the checkpoint is intact and was taken of the same, unmodified file, and false otherwise.
+static bool load_checkpoint(const char *path, const identity &file, md5::snapshot &state)
+{
+	std::ifstream in(path, std::ios::binary | std::ios::ate);
+	if (!in) {
+		return false;
+	}
+	static constexpr u64 HEADER_BYTESIZE = sizeof(CHECKPOINT_MAGIC) + 5 * sizeof(u64) + 4 * sizeof(u32);
+	const u64 size = u64(in.tellg());
+	if (size < HEADER_BYTESIZE + DIGEST_BYTESIZE || size >= HEADER_BYTESIZE + DIGEST_BYTESIZE + CHUNK_BYTESIZE) {
+		return false;
+	}
+	std::vector<u8> record(static_cast<size_t>(size));
+	in.seekg(0);
+	if (!in.read(reinterpret_cast<char*>(record.data()), std::streamsize(size))) {
+		return false;
+	}
+	const md5::sum check = md5(record.data(), size - DIGEST_BYTESIZE).digest();
+	if (memcmp(record.data(), CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0 || memcmp(static_cast<const u8*>(check), record.data() + size - DIGEST_BYTESIZE, DIGEST_BYTESIZE) != 0) {
+		return false;
+	}
+
+	const u8 *at = record.data() + sizeof(CHECKPOINT_MAGIC);
+	identity saved;
+	saved.device = consume_le<u64>(at);
+	saved.inode = consume_le<u64>(at);
+	saved.size = consume_le<u64>(at);
+	saved.mtime = consume_le<u64>(at);
+	state.message_size = consume_le<u64>(at);
+	for (u32 i = 0; i < 4; ++i) {
+		state.state[i] = consume_le<u32>(at);
+	}
+	state.chunk_size = u32(size - DIGEST_BYTESIZE - HEADER_BYTESIZE);
+	memcpy(state.chunk, at, state.chunk_size);
+	return
+		saved.device == file.device && saved.inode == file.inode && saved.size == file.size && saved.mtime == file.mtime &&
+		state.message_size <= file.size && state.chunk_size == state.message_size % CHUNK_BYTESIZE;
+}
+
+bool md5_file(const char *path, md5::sum &out)
+{
+	std::ifstream in(path, std::ios::binary);
+	if (!in) {
+		return false;
+	}
+	std::vector<char> buffer(READ_BYTESIZE);
+	md5 ctx;
+	while (in) {
+		in.read(buffer.data(), std::streamsize(buffer.size()));
+		ctx.ingest(buffer.data(), u64(in.gcount()));
+	}
+	if (in.bad()) {
+		return false;
+	}
+	out = ctx.digest();
+	return true;
+}
+
+bool md5_file(const char *path, const char *checkpoint_path, md5::sum &out, u64 interval)
+{
+	identity file;
+	std::ifstream in(path, std::ios::binary);
+	if (!in || !identify(path, file)) {
+		return false;
+	}
+
+	interval = interval > 0 ? interval : READ_BYTESIZE;
+
+	md5 ctx;
+	md5::snapshot state;
+	const bool resumed = load_checkpoint(checkpoint_path, file, state) && ctx.restore(state) && in.seekg(std::streamoff(state.message_size));
+	if (!resumed) {
+		ctx = md5();
+		in.clear();
+		in.seekg(0);
+	}
+
+	std::vector<char> buffer(READ_BYTESIZE);
+	u64 offset = ctx.save().message_size;
+	u64 next_checkpoint = (offset / interval + 1) * interval;
+	while (offset < file.size) {
+		// Reads never cross a checkpoint, so checkpoints are taken at exact multiples of the interval.
+		const u64 limit = (file.size < next_checkpoint ? file.size : next_checkpoint) - offset;
+		const u64 read_size = limit < buffer.size() ? limit : buffer.size();
+		if (!in.read(buffer.data(), std::streamsize(read_size))) {
+			return false;
+		}
+		ctx.ingest(buffer.data(), read_size);
+		offset += read_size;
+		if (offset == next_checkpoint && offset < file.size) {
+			save_checkpoint(checkpoint_path, file, ctx.save()); // A failed checkpoint only costs progress, not correctness.
+			next_checkpoint += interval;
+		}
+	}
+
+	identity after;
+	if (!identify(path, after) || after.size != file.size || after.mtime != file.mtime) { // The file was modified while it was being digested.
+		return false;
+	}
+	out = ctx.digest();
+	remove(checkpoint_path);
+	return true;
+}
@@ -0,0 +1,38 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_FILE_H_INCLUDED__
+#define MD5_FILE_H_INCLUDED__
+
+#include <cstdint>
+#include "md5.h"
+
+/// The default number of bytes digested between checkpoints.
+constexpr uint64_t MD5_FILE_CHECKPOINT_INTERVAL = uint64_t(1) << 30;
+
+/// Computes the digest of a file.
+///
+/// @param path the path of the file.
+/// @param out the destination of the digest.
+///
+/// @returns a boolean indicating true if the file could be read in full, and false otherwise.
+bool md5_file(const char *path, md5::sum &out);
+
+/// Computes the digest of a file, periodically saving the progress to a checkpoint file so that an interrupted computation can resume where it left off. The checkpoint holds the intermediate state of the digest together with the identity of the file (device, inode, size and modification time), and is replaced atomically each time it is written.
+///
+/// @param path the path of the file.
+/// @param checkpoint_path the path of the checkpoint file. If it holds a valid checkpoint of the same, unmodified file, the computation resumes from it. Otherwise the computation starts from the beginning of the file.
+/// @param out the destination of the digest.
+/// @param interval the number of bytes digested between checkpoints.
+///
+/// @returns a boolean indicating true if the file could be read in full, and false otherwise. The checkpoint file is removed on success, and kept on failure so that a later call can resume.
+bool md5_file(const char *path, const char *checkpoint_path, md5::sum &out, uint64_t interval = MD5_FILE_CHECKPOINT_INTERVAL);
+
+#endif
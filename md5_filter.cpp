@@ -0,0 +1,402 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include "md5_filter.h"
+#include "md5_io.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+	#define PREFETCH(addr) __builtin_prefetch(addr)
+#else
+	#define PREFETCH(addr)
+#endif
+
+typedef uint8_t  u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+static constexpr u32 WORDS_PER_BLOCK     = 8;   // 64-byte blocks, the size of a cache line.
+static constexpr u32 BITS_PER_BLOCK      = WORDS_PER_BLOCK * 64;
+static constexpr u32 MAX_BLOOM_HASHES    = 10;  // Bits per key that can be sliced from a digest after the block has been selected.
+static constexpr u64 MAX_BLOOM_BLOCKS    = u64(1) << 32; // Blocks addressable by the 32 bits of the digest that select the block.
+static constexpr double MIN_BLOOM_RATE   = 1e-6; // The lowest false positive rate a filter is sized for.
+static constexpr double MAX_BLOOM_RATE   = 0.5;  // The highest false positive rate a filter is sized for.
+static constexpr u32 SLOTS_PER_BUCKET    = 4;
+static constexpr u32 MAX_KICKS           = 500; // Displacements before a cuckoo filter is considered full.
+static constexpr u32 QUERY_GROUP         = 16;  // Keys located and prefetched ahead of testing in batch queries.
+static constexpr u64 LANES16             = 0x0001000100010001ULL;
+static constexpr char BLOOM_MAGIC[8]     = { 'M', 'D', '5', 'B', 'L', 'O', 'O', 'M' };
+static constexpr char CUCKOO_MAGIC[8]    = { 'M', 'D', '5', 'C', 'U', 'C', 'K', 'O' };
+
+/// Reads a 64-bit word from a digest in little endian order.
+///
+/// @param key the digest.
+/// @param i the index of the word within the digest.
+///
+/// @returns the word.
+static u64 word_of(const md5::sum &key, u32 i)
+{
+	return decode_le<u64>(static_cast<const u8*>(key) + i * sizeof(u64));
+}
+
+u64 md5_bloom::locate(const md5::sum &key, u64 *masks) const
+{
+	const u64 h0 = word_of(key, 0);
+	const u64 h1 = word_of(key, 1);
+	const u64 block = ((h0 >> 32) * m_block_count) >> 32; // Maps the high bits of the digest onto the blocks without a division.
+
+	// The remaining 96 bits of the digest are sliced into 9-bit offsets within the block.
+	for (u32 w = 0; w < WORDS_PER_BLOCK; ++w) {
+		masks[w] = 0;
+	}
+	for (u32 j = 0; j < m_hash_count; ++j) {
+		const u32 bit = j < 7 ? u32(h1 >> (j * 9)) & (BITS_PER_BLOCK - 1) : u32(h0 >> ((j - 7) * 9)) & (BITS_PER_BLOCK - 1);
+		masks[bit / 64] |= u64(1) << (bit % 64);
+	}
+	return block * WORDS_PER_BLOCK;
+}
+
+void md5_bloom::allocate(u64 block_count)
+{
+	m_block_count = block_count;
+	m_words.reset(new std::atomic<u64>[size_t(block_count * WORDS_PER_BLOCK)]);
+	for (u64 i = 0; i < block_count * WORDS_PER_BLOCK; ++i) {
+		m_words[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+md5_bloom::md5_bloom(u64 expected_keys, double false_positive_rate) : m_words(), m_block_count(0), m_hash_count(0)
+{
+	// Rates outside of the range, including NaN, would make the number of bits negative, infinite or undefined.
+	const double rate = false_positive_rate > MIN_BLOOM_RATE ? (false_positive_rate < MAX_BLOOM_RATE ? false_positive_rate : MAX_BLOOM_RATE) : MIN_BLOOM_RATE;
+	const double LN2 = std::log(2.0);
+	const double keys = expected_keys > 0 ? double(expected_keys) : 1.0;
+	const double bits = std::ceil(-keys * std::log(rate) / (LN2 * LN2));
+	const double blocks = std::ceil(bits / BITS_PER_BLOCK);
+	const u64 block_count = blocks < 1.0 ? 1 : (blocks > double(MAX_BLOOM_BLOCKS) ? MAX_BLOOM_BLOCKS : u64(blocks));
+	const double hashes = std::round(bits / keys * LN2);
+	m_hash_count = hashes < 1.0 ? 1 : (hashes > MAX_BLOOM_HASHES ? MAX_BLOOM_HASHES : u32(hashes));
+	allocate(block_count);
+}
+
+void md5_bloom::insert(const md5::sum &key)
+{
+	u64 masks[WORDS_PER_BLOCK];
+	const u64 base = locate(key, masks);
+	for (u32 w = 0; w < WORDS_PER_BLOCK; ++w) {
+		if (masks[w] != 0) {
+			m_words[base + w].store(m_words[base + w].load(std::memory_order_relaxed) | masks[w], std::memory_order_relaxed);
+		}
+	}
+}
+
+void md5_bloom::insert_concurrent(const md5::sum &key)
+{
+	u64 masks[WORDS_PER_BLOCK];
+	const u64 base = locate(key, masks);
+	for (u32 w = 0; w < WORDS_PER_BLOCK; ++w) {
+		if (masks[w] != 0) {
+			m_words[base + w].fetch_or(masks[w], std::memory_order_relaxed);
+		}
+	}
+}
+
+bool md5_bloom::contains(const md5::sum &key) const
+{
+	u64 masks[WORDS_PER_BLOCK];
+	const u64 base = locate(key, masks);
+	u64 missing = 0;
+	for (u32 w = 0; w < WORDS_PER_BLOCK; ++w) {
+		missing |= masks[w] & ~m_words[base + w].load(std::memory_order_relaxed);
+	}
+	return missing == 0;
+}
+
+u64 md5_bloom::contains(const md5::sum *keys, bool *results, u64 count) const
+{
+	u64 found = 0;
+	u64 bases[QUERY_GROUP];
+	u64 masks[QUERY_GROUP][WORDS_PER_BLOCK];
+	for (u64 i = 0; i < count; i += QUERY_GROUP) {
+		const u32 n = u32((count - i) < QUERY_GROUP ? (count - i) : QUERY_GROUP);
+		for (u32 j = 0; j < n; ++j) {
+			bases[j] = locate(keys[i + j], masks[j]);
+			PREFETCH(&m_words[bases[j]]);
+		}
+		for (u32 j = 0; j < n; ++j) {
+			u64 missing = 0;
+			for (u32 w = 0; w < WORDS_PER_BLOCK; ++w) {
+				missing |= masks[j][w] & ~m_words[bases[j] + w].load(std::memory_order_relaxed);
+			}
+			results[i + j] = missing == 0;
+			found += missing == 0 ? 1 : 0;
+		}
+	}
+	return found;
+}
+
+u64 md5_bloom::byte_size( void ) const
+{
+	return m_block_count * WORDS_PER_BLOCK * sizeof(u64);
+}
+
+bool md5_bloom::save(const char *path) const
+{
+	FILE *file = fopen(path, "wb");
+	if (file == nullptr) {
+		return false;
+	}
+	bool success = fwrite(BLOOM_MAGIC, 1, sizeof(BLOOM_MAGIC), file) == sizeof(BLOOM_MAGIC);
+	success = success && write_le(file, m_block_count) && write_le(file, u64(m_hash_count));
+	for (u64 i = 0; success && i < m_block_count * WORDS_PER_BLOCK; ++i) {
+		success = write_le(file, m_words[i].load(std::memory_order_relaxed));
+	}
+	return (fclose(file) == 0) && success;
+}
+
+bool md5_bloom::load(const char *path)
+{
+	FILE *file = fopen(path, "rb");
+	if (file == nullptr) {
+		return false;
+	}
+	char magic[sizeof(BLOOM_MAGIC)];
+	u64 block_count = 0;
+	u64 hash_count = 0;
+	bool success =
+		fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, BLOOM_MAGIC, sizeof(magic)) == 0 &&
+		read_le(file, block_count) && read_le(file, hash_count) &&
+		block_count > 0 && block_count <= MAX_BLOOM_BLOCKS && hash_count >= 1 && hash_count <= MAX_BLOOM_HASHES &&
+		block_count <= remaining_size(file) / (WORDS_PER_BLOCK * sizeof(u64)); // A corrupt count must not cause a huge allocation.
+	if (success) {
+		md5_bloom loaded(1, 0.5);
+		loaded.allocate(block_count);
+		loaded.m_hash_count = u32(hash_count);
+		for (u64 i = 0; success && i < block_count * WORDS_PER_BLOCK; ++i) {
+			u64 word = 0;
+			success = read_le(file, word);
+			loaded.m_words[i].store(word, std::memory_order_relaxed);
+		}
+		if (success) {
+			m_words.swap(loaded.m_words);
+			m_block_count = loaded.m_block_count;
+			m_hash_count = loaded.m_hash_count;
+		}
+	}
+	fclose(file);
+	return success;
+}
+
+u64 md5_cuckoo::locate(const md5::sum &key, u16 &fingerprint) const
+{
+	fingerprint = u16(word_of(key, 1));
+	if (fingerprint == 0) { // Zero marks an empty slot.
+		fingerprint = 1;
+	}
+	return word_of(key, 0) & m_bucket_mask;
+}
+
+u64 md5_cuckoo::alternate(u64 bucket, u16 fingerprint) const
+{
+	// The fingerprint is mixed before use, so that similar fingerprints do not map to nearby buckets. Applying this twice returns to the original bucket.
+	return (bucket ^ (u64(fingerprint) * 0x5bd1e995)) & m_bucket_mask;
+}
+
+bool md5_cuckoo::place(u64 bucket, u16 fingerprint)
+{
+	u64 &slots = m_buckets[bucket];
+	for (u32 s = 0; s < SLOTS_PER_BUCKET; ++s) {
+		if (((slots >> (s * 16)) & 0xffff) == 0) {
+			slots |= u64(fingerprint) << (s * 16);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool md5_cuckoo::has(u64 bucket, u16 fingerprint) const
+{
+	// Tests all four slots at once by checking for a zero 16-bit lane.
+	const u64 x = m_buckets[bucket] ^ (u64(fingerprint) * LANES16);
+	return ((x - LANES16) & ~x & (LANES16 << 15)) != 0;
+}
+
+md5_cuckoo::md5_cuckoo(u64 expected_keys) : m_buckets(), m_bucket_mask(0), m_count(0), m_victim_bucket(0), m_rng(0x9e3779b9), m_victim(0)
+{
+	// Cuckoo filters with four slots per bucket reliably reach a load of 95%.
+	const u64 min_buckets = u64(std::ceil(double(expected_keys) / (SLOTS_PER_BUCKET * 0.95)));
+	u64 bucket_count = 1;
+	while (bucket_count < min_buckets) {
+		bucket_count <<= 1;
+	}
+	m_bucket_mask = bucket_count - 1;
+	m_buckets.reset(new u64[size_t(bucket_count)]);
+	memset(m_buckets.get(), 0, size_t(bucket_count * sizeof(u64)));
+}
+
+bool md5_cuckoo::insert(const md5::sum &key)
+{
+	u16 fingerprint;
+	const u64 i1 = locate(key, fingerprint);
+	const u64 i2 = alternate(i1, fingerprint);
+	if (place(i1, fingerprint) || place(i2, fingerprint)) {
+		++m_count;
+		return true;
+	}
+	if (m_victim != 0) {
+		return false;
+	}
+
+	// Displace random fingerprints to their alternate buckets until one finds an empty slot.
+	u64 bucket = (m_rng & 1) ? i1 : i2;
+	for (u32 kick = 0; kick < MAX_KICKS; ++kick) {
+		m_rng ^= m_rng << 13;
+		m_rng ^= m_rng >> 17;
+		m_rng ^= m_rng << 5;
+		const u32 s = m_rng % SLOTS_PER_BUCKET;
+		u64 &slots = m_buckets[bucket];
+		const u16 displaced = u16(slots >> (s * 16));
+		slots = (slots & ~(u64(0xffff) << (s * 16))) | (u64(fingerprint) << (s * 16));
+		fingerprint = displaced;
+		bucket = alternate(bucket, fingerprint);
+		if (place(bucket, fingerprint)) {
+			++m_count;
+			return true;
+		}
+	}
+
+	// The last displaced fingerprint is kept aside, so that no inserted key is lost, and the filter is full from now on.
+	m_victim = fingerprint;
+	m_victim_bucket = bucket;
+	++m_count;
+	return true;
+}
+
+bool md5_cuckoo::erase(const md5::sum &key)
+{
+	u16 fingerprint;
+	const u64 i1 = locate(key, fingerprint);
+	const u64 i2 = alternate(i1, fingerprint);
+	if (m_victim == fingerprint && (m_victim_bucket == i1 || m_victim_bucket == i2)) {
+		m_victim = 0;
+		--m_count;
+		return true;
+	}
+	const u64 buckets[2] = { i1, i2 };
+	for (u32 b = 0; b < 2; ++b) {
+		u64 &slots = m_buckets[buckets[b]];
+		for (u32 s = 0; s < SLOTS_PER_BUCKET; ++s) {
+			if (((slots >> (s * 16)) & 0xffff) == fingerprint) {
+				slots &= ~(u64(0xffff) << (s * 16));
+				--m_count;
+				if (m_victim != 0 && (place(m_victim_bucket, m_victim) || place(alternate(m_victim_bucket, m_victim), m_victim))) { // Room has been made for the victim.
+					m_victim = 0;
+				}
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool md5_cuckoo::contains(const md5::sum &key) const
+{
+	u16 fingerprint;
+	const u64 i1 = locate(key, fingerprint);
+	const u64 i2 = alternate(i1, fingerprint);
+	return
+		has(i1, fingerprint) || has(i2, fingerprint) ||
+		(m_victim == fingerprint && (m_victim_bucket == i1 || m_victim_bucket == i2));
+}
+
+u64 md5_cuckoo::contains(const md5::sum *keys, bool *results, u64 count) const
+{
+	u64 found = 0;
+	u64 primary[QUERY_GROUP];
+	u64 secondary[QUERY_GROUP];
+	u16 fingerprints[QUERY_GROUP];
+	for (u64 i = 0; i < count; i += QUERY_GROUP) {
+		const u32 n = u32((count - i) < QUERY_GROUP ? (count - i) : QUERY_GROUP);
+		for (u32 j = 0; j < n; ++j) {
+			primary[j] = locate(keys[i + j], fingerprints[j]);
+			secondary[j] = alternate(primary[j], fingerprints[j]);
+			PREFETCH(&m_buckets[primary[j]]);
+			PREFETCH(&m_buckets[secondary[j]]);
+		}
+		for (u32 j = 0; j < n; ++j) {
+			const bool result =
+				has(primary[j], fingerprints[j]) || has(secondary[j], fingerprints[j]) ||
+				(m_victim == fingerprints[j] && (m_victim_bucket == primary[j] || m_victim_bucket == secondary[j]));
+			results[i + j] = result;
+			found += result ? 1 : 0;
+		}
+	}
+	return found;
+}
+
+u64 md5_cuckoo::count( void ) const
+{
+	return m_count;
+}
+
+u64 md5_cuckoo::byte_size( void ) const
+{
+	return (m_bucket_mask + 1) * sizeof(u64);
+}
+
+bool md5_cuckoo::save(const char *path) const
+{
+	FILE *file = fopen(path, "wb");
+	if (file == nullptr) {
+		return false;
+	}
+	bool success = fwrite(CUCKOO_MAGIC, 1, sizeof(CUCKOO_MAGIC), file) == sizeof(CUCKOO_MAGIC);
+	success = success && write_le(file, m_bucket_mask + 1) && write_le(file, m_count) && write_le(file, u64(m_victim)) && write_le(file, m_victim_bucket);
+	for (u64 i = 0; success && i <= m_bucket_mask; ++i) {
+		success = write_le(file, m_buckets[i]);
+	}
+	return (fclose(file) == 0) && success;
+}
+
+bool md5_cuckoo::load(const char *path)
+{
+	FILE *file = fopen(path, "rb");
+	if (file == nullptr) {
+		return false;
+	}
+	char magic[sizeof(CUCKOO_MAGIC)];
+	u64 bucket_count = 0;
+	u64 count = 0;
+	u64 victim = 0;
+	u64 victim_bucket = 0;
+	bool success =
+		fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, CUCKOO_MAGIC, sizeof(magic)) == 0 &&
+		read_le(file, bucket_count) && read_le(file, count) && read_le(file, victim) && read_le(file, victim_bucket) &&
+		bucket_count > 0 && (bucket_count & (bucket_count - 1)) == 0 && victim <= 0xffff && victim_bucket < bucket_count &&
+		bucket_count <= remaining_size(file) / sizeof(u64); // A corrupt count must not cause a huge allocation.
+	if (success) {
+		std::unique_ptr<u64[]> buckets(new u64[size_t(bucket_count)]);
+		for (u64 i = 0; success && i < bucket_count; ++i) {
+			success = read_le(file, buckets[i]);
+		}
+		if (success) {
+			m_buckets.swap(buckets);
+			m_bucket_mask = bucket_count - 1;
+			m_count = count;
+			m_victim = u16(victim);
+			m_victim_bucket = victim_bucket;
+		}
+	}
+	fclose(file);
+	return success;
+}
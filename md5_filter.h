@@ -0,0 +1,192 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_FILTER_H_INCLUDED__
+#define MD5_FILTER_H_INCLUDED__
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "md5.h"
+
+/// A cache-line blocked Bloom filter of MD5 digests. Digests are already uniformly distributed, so the block and the bits within the block are sliced directly from the bits of the digest without further hashing. All bits of a key are within the same 64-byte block, so a query touches a single cache line.
+///
+/// @note Supports up to 10 bits per key.
+class md5_bloom
+{
+private:
+	std::unique_ptr<std::atomic<uint64_t>[]> m_words;
+	uint64_t                                 m_block_count;
+	uint32_t                                 m_hash_count;
+
+private:
+	/// Computes the block of a key and the bits to test within each word of the block.
+	///
+	/// @param key the key.
+	/// @param masks the destination of the bits to test within each of the 8 words of the block.
+	///
+	/// @returns the index of the first word of the block.
+	uint64_t locate(const md5::sum &key, uint64_t *masks) const;
+	/// Allocates and clears the words of the filter.
+	///
+	/// @param block_count the number of blocks.
+	void allocate(uint64_t block_count);
+
+public:
+	/// Creates an empty filter sized for a number of keys and a false positive rate.
+	///
+	/// @param expected_keys the number of keys the filter is expected to hold.
+	/// @param false_positive_rate the target probability of a query returning true for a key that was never inserted. Clamped to between 0.000001 and 0.5.
+	md5_bloom(uint64_t expected_keys, double false_positive_rate);
+
+	/// Inserts a key. Not safe to call concurrently with other inserts.
+	///
+	/// @param key the key.
+	void insert(const md5::sum &key);
+	/// Inserts a key using atomic operations. Safe to call concurrently with other calls to 'insert_concurrent' and 'contains'.
+	///
+	/// @param key the key.
+	void insert_concurrent(const md5::sum &key);
+
+	/// Checks if a key may be in the filter.
+	///
+	/// @param key the key.
+	///
+	/// @returns a boolean indicating true if the key may have been inserted, and false if it definitely was not.
+	bool contains(const md5::sum &key) const;
+	/// Checks if several keys may be in the filter. The blocks of a group of keys are located and prefetched before any of them are tested, which hides memory latency.
+	///
+	/// @param keys the keys.
+	/// @param results the destination of the result of each key.
+	/// @param count the number of keys.
+	///
+	/// @returns the number of keys that may be in the filter.
+	uint64_t contains(const md5::sum *keys, bool *results, uint64_t count) const;
+
+	/// Returns the memory used by the bits of the filter.
+	///
+	/// @returns the number of bytes.
+	uint64_t byte_size( void ) const;
+
+	/// Writes the filter to a file.
+	///
+	/// @param path the path of the file.
+	///
+	/// @returns a boolean indicating true if the file was written, and false otherwise.
+	bool save(const char *path) const;
+	/// Reads a filter from a file written by 'save'.
+	///
+	/// @param path the path of the file.
+	///
+	/// @returns a boolean indicating true if the file was read, and false otherwise, in which case the filter is left unmodified.
+	bool load(const char *path);
+};
+
+/// A cuckoo filter of MD5 digests with 16-bit fingerprints and four fingerprints per bucket. The bucket and fingerprint are sliced directly from the bits of the digest without further hashing. Unlike a Bloom filter, keys can be erased.
+///
+/// @note Inserts are not safe to call concurrently with other inserts or queries.
+class md5_cuckoo
+{
+private:
+	std::unique_ptr<uint64_t[]> m_buckets; // Four 16-bit fingerprints per bucket, zero meaning empty.
+	uint64_t                    m_bucket_mask;
+	uint64_t                    m_count;
+	uint64_t                    m_victim_bucket;
+	uint32_t                    m_rng;
+	uint16_t                    m_victim;      // A fingerprint that could not be placed, or zero.
+
+private:
+	/// Computes the fingerprint and primary bucket of a key.
+	///
+	/// @param key the key.
+	/// @param fingerprint the destination fingerprint.
+	///
+	/// @returns the primary bucket.
+	uint64_t locate(const md5::sum &key, uint16_t &fingerprint) const;
+	/// Returns the alternate bucket of a fingerprint.
+	///
+	/// @param bucket the current bucket of the fingerprint.
+	/// @param fingerprint the fingerprint.
+	///
+	/// @returns the alternate bucket.
+	uint64_t alternate(uint64_t bucket, uint16_t fingerprint) const;
+	/// Places a fingerprint in an empty slot of a bucket.
+	///
+	/// @param bucket the bucket.
+	/// @param fingerprint the fingerprint.
+	///
+	/// @returns a boolean indicating true if the bucket had an empty slot, and false otherwise.
+	bool place(uint64_t bucket, uint16_t fingerprint);
+	/// Checks if a bucket contains a fingerprint.
+	///
+	/// @param bucket the bucket.
+	/// @param fingerprint the fingerprint.
+	///
+	/// @returns a boolean indicating true if the fingerprint is in the bucket, and false otherwise.
+	bool has(uint64_t bucket, uint16_t fingerprint) const;
+
+public:
+	/// Creates an empty filter sized for a number of keys.
+	///
+	/// @param expected_keys the number of keys the filter is expected to hold.
+	md5_cuckoo(uint64_t expected_keys);
+
+	/// Inserts a key.
+	///
+	/// @param key the key.
+	///
+	/// @returns a boolean indicating true if the key was inserted, and false if the filter is full.
+	bool insert(const md5::sum &key);
+	/// Erases a key. Must only be called for keys that have been inserted.
+	///
+	/// @param key the key.
+	///
+	/// @returns a boolean indicating true if the key was found and erased, and false otherwise.
+	bool erase(const md5::sum &key);
+
+	/// Checks if a key may be in the filter.
+	///
+	/// @param key the key.
+	///
+	/// @returns a boolean indicating true if the key may have been inserted, and false if it definitely was not.
+	bool contains(const md5::sum &key) const;
+	/// Checks if several keys may be in the filter. The buckets of a group of keys are located and prefetched before any of them are tested, which hides memory latency.
+	///
+	/// @param keys the keys.
+	/// @param results the destination of the result of each key.
+	/// @param count the number of keys.
+	///
+	/// @returns the number of keys that may be in the filter.
+	uint64_t contains(const md5::sum *keys, bool *results, uint64_t count) const;
+
+	/// Returns the number of keys in the filter.
+	///
+	/// @returns the number of keys.
+	uint64_t count( void ) const;
+	/// Returns the memory used by the buckets of the filter.
+	///
+	/// @returns the number of bytes.
+	uint64_t byte_size( void ) const;
+
+	/// Writes the filter to a file.
+	///
+	/// @param path the path of the file.
+	///
+	/// @returns a boolean indicating true if the file was written, and false otherwise.
+	bool save(const char *path) const;
+	/// Reads a filter from a file written by 'save'.
+	///
+	/// @param path the path of the file.
+	///
+	/// @returns a boolean indicating true if the file was read, and false otherwise, in which case the filter is left unmodified.
+	bool load(const char *path);
+};
+
+#endif
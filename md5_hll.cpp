@@ -0,0 +1,227 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#include <cmath>
+#include <limits>
+#include "md5_hll.h"
+#include "md5_io.h"
+
+typedef uint8_t  u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+static constexpr u32 MIN_PRECISION = 4;
+static constexpr u32 MAX_PRECISION = 18;
+static constexpr u32 ADD_GROUP     = 64; // Messages hashed per call to 'md5_batch'.
+static constexpr u8  HLL_MAGIC[4]  = { 'M', 'D', '5', 'H' };
+
+/// Reads the first 64 bits of a digest in little endian order.
+///
+/// @param key the digest.
+///
+/// @returns the hash.
+static u64 hash_of(const md5::sum &key)
+{
+	return decode_le<u64>(key);
+}
+
+/// Counts the leading zero bits of a non-zero word.
+///
+/// @param x the word.
+///
+/// @returns the number of leading zero bits.
+static u32 leading_zeros(u64 x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return u32(__builtin_clzll(x));
+#else
+	u32 n = 0;
+	while ((x & (u64(1) << 63)) == 0) {
+		x <<= 1;
+		++n;
+	}
+	return n;
+#endif
+}
+
+/// Ertl's sigma function, correcting for registers that have not been set.
+///
+/// @param x the fraction of registers that are zero.
+///
+/// @returns sigma(x).
+static double sigma(double x)
+{
+	if (x == 1.0) {
+		return std::numeric_limits<double>::infinity();
+	}
+	double y = 1.0;
+	double z = x;
+	double z_prev;
+	do {
+		x *= x;
+		z_prev = z;
+		z += x * y;
+		y += y;
+	} while (z != z_prev);
+	return z;
+}
+
+/// Ertl's tau function, correcting for registers that have saturated.
+///
+/// @param x the fraction of registers that are not saturated.
+///
+/// @returns tau(x).
+static double tau(double x)
+{
+	if (x == 0.0 || x == 1.0) {
+		return 0.0;
+	}
+	double y = 1.0;
+	double z = 1.0 - x;
+	double z_prev;
+	do {
+		x = std::sqrt(x);
+		z_prev = z;
+		y *= 0.5;
+		z -= (1.0 - x) * (1.0 - x) * y;
+	} while (z != z_prev);
+	return z / 3.0;
+}
+
+void md5_hll::add_hash(u64 hash)
+{
+	const u64 index = hash >> (64 - m_precision);
+	// The marker bit limits the rank to 64 - precision + 1 when the remaining bits are all zero.
+	const u8 rank = u8(leading_zeros((hash << m_precision) | (u64(1) << (m_precision - 1))) + 1);
+	if (m_registers[index] < rank) {
+		m_registers[index] = rank;
+	}
+}
+
+md5_hll::md5_hll(u32 precision) : m_registers(), m_precision(precision < MIN_PRECISION ? MIN_PRECISION : (precision > MAX_PRECISION ? MAX_PRECISION : precision))
+{
+	m_registers.resize(size_t(1) << m_precision, 0);
+}
+
+void md5_hll::add(const md5::sum &key)
+{
+	add_hash(hash_of(key));
+}
+
+void md5_hll::add(const md5::sum *keys, u64 count)
+{
+	for (u64 i = 0; i < count; ++i) {
+		add_hash(hash_of(keys[i]));
+	}
+}
+
+void md5_hll::add(const void *message, u64 byte_count)
+{
+	add_hash(hash_of(md5(message, byte_count).digest()));
+}
+
+void md5_hll::add(const void *const *messages, const u64 *byte_counts, u64 count)
+{
+	md5::sum sums[ADD_GROUP];
+	for (u64 i = 0; i < count; i += ADD_GROUP) {
+		const u64 n = (count - i) < ADD_GROUP ? (count - i) : ADD_GROUP;
+		md5_batch(messages + i, byte_counts + i, sums, n);
+		add(sums, n);
+	}
+}
+
+bool md5_hll::merge(const md5_hll &other)
+{
+	if (other.m_precision != m_precision) {
+		return false;
+	}
+	for (size_t i = 0; i < m_registers.size(); ++i) {
+		if (m_registers[i] < other.m_registers[i]) {
+			m_registers[i] = other.m_registers[i];
+		}
+	}
+	return true;
+}
+
+void md5_hll::clear( void )
+{
+	for (size_t i = 0; i < m_registers.size(); ++i) {
+		m_registers[i] = 0;
+	}
+}
+
+double md5_hll::estimate( void ) const
+{
+	const u32 q = 64 - m_precision;
+	const double m = double(m_registers.size());
+
+	u64 histogram[64 + 2] = { 0 };
+	for (size_t i = 0; i < m_registers.size(); ++i) {
+		++histogram[m_registers[i]];
+	}
+	if (histogram[0] == m_registers.size()) {
+		return 0.0;
+	}
+
+	double z = m * tau(1.0 - double(histogram[q + 1]) / m);
+	for (u32 k = q; k >= 1; --k) {
+		z = 0.5 * (z + double(histogram[k]));
+	}
+	z += m * sigma(double(histogram[0]) / m);
+	return m * m / (2.0 * std::log(2.0) * z);
+}
+
+u32 md5_hll::precision( void ) const
+{
+	return m_precision;
+}
+
+u64 md5_hll::serialized_size( void ) const
+{
+	return MD5_HLL_HEADER_SIZE + m_registers.size();
+}
+
+u8 *md5_hll::serialize(u8 *out) const
+{
+	for (u32 i = 0; i < sizeof(HLL_MAGIC); ++i) {
+		*out++ = HLL_MAGIC[i];
+	}
+	*out++ = u8(m_precision);
+	for (size_t i = 0; i < m_registers.size(); ++i) {
+		*out++ = m_registers[i];
+	}
+	return out;
+}
+
+const u8 *md5_hll::deserialize(const u8 *in, u64 byte_count)
+{
+	if (byte_count < MD5_HLL_HEADER_SIZE) {
+		return nullptr;
+	}
+	for (u32 i = 0; i < sizeof(HLL_MAGIC); ++i) {
+		if (in[i] != HLL_MAGIC[i]) {
+			return nullptr;
+		}
+	}
+	const u32 precision = in[sizeof(HLL_MAGIC)];
+	if (precision < MIN_PRECISION || precision > MAX_PRECISION || byte_count - MD5_HLL_HEADER_SIZE < (u64(1) << precision)) {
+		return nullptr;
+	}
+	in += MD5_HLL_HEADER_SIZE;
+	const u32 max_rank = 64 - precision + 1;
+	for (u64 i = 0; i < (u64(1) << precision); ++i) {
+		if (in[i] > max_rank) {
+			return nullptr;
+		}
+	}
+	m_precision = precision;
+	m_registers.assign(in, in + (size_t(1) << precision));
+	return in + m_registers.size();
+}
@@ -0,0 +1,103 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_HLL_H_INCLUDED__
+#define MD5_HLL_H_INCLUDED__
+
+#include <cstdint>
+#include <vector>
+#include "md5.h"
+
+/// The number of bytes in the header of a serialized sketch.
+constexpr uint32_t MD5_HLL_HEADER_SIZE = 5;
+
+/// A HyperLogLog sketch estimating the number of distinct digests added to it. The first 64 bits of a digest provide both the register index and the rank, so no additional hashing is needed.
+///
+/// @note The estimate uses the improved raw estimator by Otmar Ertl, which is accurate across the whole range of cardinalities without the empirical bias tables of HLL++.
+/// @note Sketches of the same precision can be merged, e.g. when counting on several threads or nodes.
+class md5_hll
+{
+private:
+	std::vector<uint8_t> m_registers;
+	uint32_t             m_precision;
+
+private:
+	/// Adds a 64-bit hash to the sketch.
+	///
+	/// @param hash the hash.
+	void add_hash(uint64_t hash);
+
+public:
+	/// Creates an empty sketch.
+	///
+	/// @param precision the number of bits of the register index. Clamped to [4, 18]. The sketch uses 2^precision bytes and the standard error of an estimate is about 1.04/sqrt(2^precision).
+	explicit md5_hll(uint32_t precision = 14);
+
+	/// Adds a digest.
+	///
+	/// @param key the digest.
+	void add(const md5::sum &key);
+	/// Adds several digests.
+	///
+	/// @param keys the digests.
+	/// @param count the number of digests.
+	void add(const md5::sum *keys, uint64_t count);
+	/// Hashes and adds a message. Explicit length.
+	///
+	/// @param message the message.
+	/// @param byte_count the number of bytes in the message.
+	void add(const void *message, uint64_t byte_count);
+	/// Hashes and adds several messages. Messages are hashed in lock-step with 'md5_batch'.
+	///
+	/// @param messages the messages.
+	/// @param byte_counts the number of bytes in each message.
+	/// @param count the number of messages.
+	void add(const void *const *messages, const uint64_t *byte_counts, uint64_t count);
+
+	/// Merges another sketch into this one. The result estimates the number of distinct digests in the union of both sketches.
+	///
+	/// @param other the other sketch.
+	///
+	/// @returns a boolean indicating true if the sketches were merged, and false if their precisions differ.
+	bool merge(const md5_hll &other);
+
+	/// Removes all digests from the sketch.
+	void clear( void );
+
+	/// Estimates the number of distinct digests added to the sketch.
+	///
+	/// @returns the estimate.
+	double estimate( void ) const;
+
+	/// Returns the precision of the sketch.
+	///
+	/// @returns the precision.
+	uint32_t precision( void ) const;
+
+	/// Returns the number of bytes needed to serialize the sketch.
+	///
+	/// @returns the number of bytes.
+	uint64_t serialized_size( void ) const;
+	/// Serializes the sketch.
+	///
+	/// @param out the destination buffer, at least 'serialized_size' bytes large.
+	///
+	/// @returns a pointer to the byte after the last written byte.
+	uint8_t *serialize(uint8_t *out) const;
+	/// Replaces the sketch with a serialized sketch.
+	///
+	/// @param in the serialized sketch.
+	/// @param byte_count the number of bytes in the buffer.
+	///
+	/// @returns a pointer to the byte after the last read byte. Null if the buffer does not contain a valid sketch, in which case the sketch is left unchanged.
+	const uint8_t *deserialize(const uint8_t *in, uint64_t byte_count);
+};
+
+#endif
@@ -0,0 +1,178 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#include <cstring>
+#include "md5_hmac.h"
+#include "md5_io.h"
+
+typedef uint8_t  u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+static constexpr u32 BATCH_SIZE = MD5_LANES * 8; // The number of messages verified per batch.
+
+/// Sets up the padded key blocks and compresses them into the inner and outer states.
+///
+/// @param key the key.
+/// @param key_size the number of bytes in the key.
+/// @param inner the destination inner state.
+/// @param outer the destination outer state.
+static void setup(const void *key, u64 key_size, u32 *inner, u32 *outer)
+{
+	u8 block[CHUNK_BYTESIZE];
+	memset(block, 0, sizeof(block));
+	if (key_size > CHUNK_BYTESIZE) { // Keys longer than a block are shortened by hashing.
+		const md5::sum key_sum = md5(key, key_size).digest();
+		memcpy(block, static_cast<const u8*>(key_sum), DIGEST_BYTESIZE);
+	} else {
+		memcpy(block, key, size_t(key_size));
+	}
+
+	for (u32 i = 0; i < CHUNK_BYTESIZE; ++i) {
+		block[i] ^= 0x36;
+	}
+	md5_init(inner);
+	md5_compress(inner, block, 1);
+
+	for (u32 i = 0; i < CHUNK_BYTESIZE; ++i) {
+		block[i] ^= 0x36 ^ 0x5c;
+	}
+	md5_init(outer);
+	md5_compress(outer, block, 1);
+
+	// Clear sensitive data.
+	memset(block, 0, sizeof(block));
+}
+
+/// Builds the block of the outer hash of HMAC. The outer message is always a padded key block followed by a digest, so the remainder always fits a single block with a fixed padding.
+///
+/// @param inner_sum the digest of the inner hash.
+/// @param block the destination block.
+static void outer_block(const md5::sum &inner_sum, u8 *block)
+{
+	static constexpr u64 OUTER_MESSAGE_BITSIZE = (CHUNK_BYTESIZE + DIGEST_BYTESIZE) * 8;
+	memcpy(block, static_cast<const u8*>(inner_sum), DIGEST_BYTESIZE);
+	block[DIGEST_BYTESIZE] = 0x80;
+	memset(block + DIGEST_BYTESIZE + 1, 0, CHUNK_BYTESIZE - DIGEST_BYTESIZE - 1);
+	for (u32 i = 0; i < sizeof(u64); ++i) {
+		block[CHUNK_BYTESIZE - sizeof(u64) + i] = u8(OUTER_MESSAGE_BITSIZE >> (i * 8));
+	}
+}
+
+/// Computes the outer hash of HMAC.
+///
+/// @param outer the outer state.
+/// @param inner_sum the digest of the inner hash.
+///
+/// @returns the tag.
+static md5::sum outer_hash(const u32 *outer, const md5::sum &inner_sum)
+{
+	u8 block[CHUNK_BYTESIZE];
+	outer_block(inner_sum, block);
+	u32 X[4];
+	memcpy(X, outer, sizeof(X));
+	md5_compress(X, block, 1);
+	return md5_state_sum(X);
+}
+
+hmac_md5::hmac_md5(const char *key)
+{
+	setup(key, u64(strlen(key)), m_inner, m_outer);
+}
+
+hmac_md5::hmac_md5(const void *key, u64 key_size)
+{
+	setup(key, key_size, m_inner, m_outer);
+}
+
+hmac_md5::~hmac_md5( void )
+{
+	// Clear sensitive data.
+	memset(m_inner, 0, sizeof(m_inner));
+	memset(m_outer, 0, sizeof(m_outer));
+}
+
+md5::sum hmac_md5::sign(const char *message) const
+{
+	return sign(message, u64(strlen(message)));
+}
+
+md5::sum hmac_md5::sign(const void *message, u64 byte_count) const
+{
+	return outer_hash(m_outer, md5_finalize(m_inner, message, byte_count, CHUNK_BYTESIZE + byte_count));
+}
+
+bool hmac_md5::verify(const void *message, u64 byte_count, const md5::sum &tag) const
+{
+	return equal(sign(message, byte_count), tag);
+}
+
+u64 hmac_md5::verify(const void *const *messages, const u64 *byte_counts, const md5::sum *tags, bool *results, u64 count) const
+{
+	const hmac_md5 *keys[BATCH_SIZE];
+	for (u32 i = 0; i < BATCH_SIZE; ++i) {
+		keys[i] = this;
+	}
+	u64 authentic = 0;
+	for (u64 i = 0; i < count; i += BATCH_SIZE) {
+		const u64 n = (count - i) < BATCH_SIZE ? (count - i) : BATCH_SIZE;
+		authentic += verify(keys, messages + i, byte_counts + i, tags + i, results + i, n);
+	}
+	return authentic;
+}
+
+u64 hmac_md5::verify(const hmac_md5 *const *keys, const void *const *messages, const u64 *byte_counts, const md5::sum *tags, bool *results, u64 count)
+{
+	u64 authentic = 0;
+	for (u64 base = 0; base < count; base += BATCH_SIZE) {
+		const u64 n = (count - base) < BATCH_SIZE ? (count - base) : BATCH_SIZE;
+
+		// Inner hashes, continuing from the inner state of each key.
+		const u32 *inner[BATCH_SIZE];
+		md5::sum inner_sums[BATCH_SIZE];
+		for (u64 i = 0; i < n; ++i) {
+			inner[i] = keys[base + i]->m_inner;
+		}
+		md5_batch_from_states(inner, CHUNK_BYTESIZE, messages + base, byte_counts + base, inner_sums, n);
+
+		// Outer hashes, a single block each.
+		for (u64 i = 0; i < n; i += MD5_LANES) {
+			const u32 lane_count = u32((n - i) < MD5_LANES ? (n - i) : MD5_LANES);
+			u32 X[MD5_LANES][4];
+			u8 blocks[MD5_LANES][CHUNK_BYTESIZE];
+			u32 *states[MD5_LANES];
+			const void *lane_blocks[MD5_LANES];
+			for (u32 l = 0; l < lane_count; ++l) {
+				memcpy(X[l], keys[base + i + l]->m_outer, sizeof(X[l]));
+				outer_block(inner_sums[i + l], blocks[l]);
+				states[l] = X[l];
+				lane_blocks[l] = blocks[l];
+			}
+			md5_compress_lanes(states, lane_blocks, lane_count);
+			for (u32 l = 0; l < lane_count; ++l) {
+				const u64 item = base + i + l;
+				results[item] = equal(md5_state_sum(X[l]), tags[item]);
+				authentic += results[item] ? 1 : 0;
+			}
+		}
+	}
+	return authentic;
+}
+
+bool hmac_md5::equal(const md5::sum &a, const md5::sum &b)
+{
+	const u8 *x = a;
+	const u8 *y = b;
+	u8 diff = 0;
+	for (u32 i = 0; i < DIGEST_BYTESIZE; ++i) {
+		diff |= x[i] ^ y[i];
+	}
+	return diff == 0;
+}
@@ -0,0 +1,98 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_HMAC_H_INCLUDED__
+#define MD5_HMAC_H_INCLUDED__
+
+#include <cstdint>
+#include "md5.h"
+
+/// Computes and verifies HMAC-MD5 (RFC 2104) message authentication codes for a fixed key. The inner and outer padded key blocks are compressed once when the key is set, so signing a message only costs the compression of the message itself plus a single block for the outer hash.
+///
+/// @note Verification compares tags in constant time.
+class hmac_md5
+{
+private:
+	uint32_t m_inner[4];
+	uint32_t m_outer[4];
+
+public:
+	/// Sets up the key. Length is inferred from zero-terminator.
+	///
+	/// @param key the key.
+	hmac_md5(const char *key);
+	/// Sets up the key. Explicit length.
+	///
+	/// @param key the key.
+	/// @param key_size the number of bytes in the key.
+	hmac_md5(const void *key, uint64_t key_size);
+	/// Clear out sensitive data.
+	~hmac_md5( void );
+
+	/// Default copy constructor.
+	hmac_md5(const hmac_md5&) = default;
+	/// Default assingment operator.
+	hmac_md5 &operator=(const hmac_md5&) = default;
+
+	/// Computes the tag of a message. Length is inferred from zero-terminator.
+	///
+	/// @param message the message to sign.
+	///
+	/// @returns the tag.
+	md5::sum sign(const char *message) const;
+	/// Computes the tag of a message. Explicit length.
+	///
+	/// @param message the message to sign.
+	/// @param byte_count the number of bytes in the message.
+	///
+	/// @returns the tag.
+	md5::sum sign(const void *message, uint64_t byte_count) const;
+
+	/// Verifies the tag of a message.
+	///
+	/// @param message the message to verify.
+	/// @param byte_count the number of bytes in the message.
+	/// @param tag the expected tag of the message.
+	///
+	/// @returns a boolean indicating true if the tag matches the message, and false otherwise.
+	bool verify(const void *message, uint64_t byte_count, const md5::sum &tag) const;
+	/// Verifies the tags of several messages signed with the same key.
+	///
+	/// @param messages the messages to verify.
+	/// @param byte_counts the number of bytes in each message.
+	/// @param tags the expected tag of each message.
+	/// @param results the destination of the result of each verification.
+	/// @param count the number of messages to verify.
+	///
+	/// @returns the number of messages that were verified as authentic.
+	uint64_t verify(const void *const *messages, const uint64_t *byte_counts, const md5::sum *tags, bool *results, uint64_t count) const;
+
+	/// Verifies the tags of several messages, each signed with its own key. The inner and outer hashes of up to MD5_LANES messages are computed in lock-step.
+	///
+	/// @param keys the key of each message.
+	/// @param messages the messages to verify.
+	/// @param byte_counts the number of bytes in each message.
+	/// @param tags the expected tag of each message.
+	/// @param results the destination of the result of each verification.
+	/// @param count the number of messages to verify.
+	///
+	/// @returns the number of messages that were verified as authentic.
+	static uint64_t verify(const hmac_md5 *const *keys, const void *const *messages, const uint64_t *byte_counts, const md5::sum *tags, bool *results, uint64_t count);
+
+	/// Compares two tags in constant time.
+	///
+	/// @param a the first tag.
+	/// @param b the second tag.
+	///
+	/// @returns a boolean indicating true if the tags are equal, and false otherwise.
+	static bool equal(const md5::sum &a, const md5::sum &b);
+};
+
+#endif
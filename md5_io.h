@@ -0,0 +1,175 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_IO_H_INCLUDED__
+#define MD5_IO_H_INCLUDED__
+
+// Internal constants and helpers shared by the modules. Only included by source files; not part of the interface of any module.
+
+#include <cstdint>
+#include <cstdio>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+static constexpr uint32_t DIGEST_BYTESIZE = 16; // The number of bytes in an MD5 digest.
+static constexpr uint32_t CHUNK_BYTESIZE  = 64; // The number of bytes in an MD5 block.
+
+/// Encodes a word in little endian order.
+///
+/// @param bytes the destination of sizeof(word_t) bytes.
+/// @param word the word.
+template < typename word_t >
+static inline void encode_le(uint8_t *bytes, word_t word)
+{
+	for (uint32_t i = 0; i < sizeof(word_t); ++i) {
+		bytes[i] = uint8_t(word >> (i * 8));
+	}
+}
+
+/// Decodes a word stored in little endian order.
+///
+/// @param bytes the sizeof(word_t) bytes of the word.
+///
+/// @returns the word.
+template < typename word_t >
+static inline word_t decode_le(const uint8_t *bytes)
+{
+	word_t word = 0;
+	for (uint32_t i = 0; i < sizeof(word_t); ++i) {
+		word |= word_t(bytes[i]) << (i * 8);
+	}
+	return word;
+}
+
+/// Writes a word to a stream in little endian order.
+///
+/// @param out the stream.
+/// @param word the word.
+///
+/// @returns a boolean indicating true if the word was written, and false otherwise.
+template < typename word_t >
+static inline bool write_le(std::ostream &out, word_t word)
+{
+	uint8_t bytes[sizeof(word_t)];
+	encode_le(bytes, word);
+	return bool(out.write(reinterpret_cast<const char*>(bytes), sizeof(bytes)));
+}
+
+/// Reads a word from a stream in little endian order.
+///
+/// @param in the stream.
+/// @param word the destination word.
+///
+/// @returns a boolean indicating true if the word was read, and false otherwise.
+template < typename word_t >
+static inline bool read_le(std::istream &in, word_t &word)
+{
+	uint8_t bytes[sizeof(word_t)];
+	if (!in.read(reinterpret_cast<char*>(bytes), sizeof(bytes))) {
+		return false;
+	}
+	word = decode_le<word_t>(bytes);
+	return true;
+}
+
+/// Writes a word to a file in little endian order.
+///
+/// @param file the file.
+/// @param word the word.
+///
+/// @returns a boolean indicating true if the word was written, and false otherwise.
+template < typename word_t >
+static inline bool write_le(FILE *file, word_t word)
+{
+	uint8_t bytes[sizeof(word_t)];
+	encode_le(bytes, word);
+	return fwrite(bytes, 1, sizeof(bytes), file) == sizeof(bytes);
+}
+
+/// Reads a word from a file in little endian order.
+///
+/// @param file the file.
+/// @param word the destination word.
+///
+/// @returns a boolean indicating true if the word was read, and false otherwise.
+template < typename word_t >
+static inline bool read_le(FILE *file, word_t &word)
+{
+	uint8_t bytes[sizeof(word_t)];
+	if (fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes)) {
+		return false;
+	}
+	word = decode_le<word_t>(bytes);
+	return true;
+}
+
+/// Appends a word to a record in little endian order.
+///
+/// @param record the record.
+/// @param word the word.
+template < typename word_t >
+static inline void append_le(std::vector<uint8_t> &record, word_t word)
+{
+	uint8_t bytes[sizeof(word_t)];
+	encode_le(bytes, word);
+	record.insert(record.end(), bytes, bytes + sizeof(bytes));
+}
+
+/// Reads a word from a record in little endian order.
+///
+/// @param record the position in the record, advanced past the word.
+///
+/// @returns the word.
+template < typename word_t >
+static inline word_t consume_le(const uint8_t *&record)
+{
+	const word_t word = decode_le<word_t>(record);
+	record += sizeof(word_t);
+	return word;
+}
+
+/// Returns the number of bytes left in a file after the current position.
+///
+/// @param file the file.
+///
+/// @returns the number of bytes, or zero if the file can not be sized.
+static inline uint64_t remaining_size(FILE *file)
+{
+	const long position = ftell(file);
+	if (position < 0 || fseek(file, 0, SEEK_END) != 0) {
+		return 0;
+	}
+	const long end = ftell(file);
+	if (end < position || fseek(file, position, SEEK_SET) != 0) {
+		return 0;
+	}
+	return uint64_t(end - position);
+}
+
+/// Returns the number of bytes left in a stream after the current position.
+///
+/// @param in the stream.
+///
+/// @returns the number of bytes, or zero if the stream can not be sized.
+static inline uint64_t remaining_size(std::istream &in)
+{
+	const std::streamoff position = in.tellg();
+	if (position < 0 || !in.seekg(0, std::ios::end)) {
+		return 0;
+	}
+	const std::streamoff end = in.tellg();
+	if (end < position || !in.seekg(position, std::ios::beg)) {
+		return 0;
+	}
+	return uint64_t(end - position);
+}
+
+#endif
@@ -0,0 +1,149 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#include <cstring>
+#include <fstream>
+#include "md5_log.h"
+#include "md5_io.h"
+
+typedef uint8_t  u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+static constexpr u32  STATE_WORDS  = 4;
+static constexpr char LOG_MAGIC[8] = { 'M', 'D', '5', 'L', 'O', 'G', 'I', '1' };
+
+md5_log::md5_log(u64 interval) : m_md5(), m_checkpoints(), m_interval(interval < CHUNK_BYTESIZE ? CHUNK_BYTESIZE : (interval + CHUNK_BYTESIZE - 1) / CHUNK_BYTESIZE * CHUNK_BYTESIZE)
+{
+	md5::snapshot state = m_md5.save();
+	m_checkpoints.insert(m_checkpoints.end(), state.state, state.state + STATE_WORDS);
+}
+
+void md5_log::append(const void *data, u64 byte_count)
+{
+	const u8 *bytes = reinterpret_cast<const u8*>(data);
+	while (byte_count > 0) {
+		const u64 size = m_md5.save().message_size;
+		const u64 remaining = m_interval - size % m_interval;
+		const u64 ingest_size = remaining < byte_count ? remaining : byte_count;
+		m_md5.ingest(bytes, ingest_size);
+		bytes += ingest_size;
+		byte_count -= ingest_size;
+		if (ingest_size == remaining) { // The interval is a multiple of the chunk size, so the state has no buffered bytes here.
+			const md5::snapshot state = m_md5.save();
+			m_checkpoints.insert(m_checkpoints.end(), state.state, state.state + STATE_WORDS);
+		}
+	}
+}
+
+u64 md5_log::checkpoint(u64 prefix_size) const
+{
+	return prefix_size / m_interval * m_interval;
+}
+
+md5::sum md5_log::prefix(u64 prefix_size, const void *tail) const
+{
+	const u64 offset = checkpoint(prefix_size);
+	return md5_finalize(m_checkpoints.data() + (offset / m_interval) * STATE_WORDS, tail, prefix_size - offset, prefix_size);
+}
+
+bool md5_log::prefix_file(const char *path, u64 prefix_size, md5::sum &out) const
+{
+	const u64 offset = checkpoint(prefix_size);
+	std::ifstream file(path, std::ios::binary);
+	std::vector<char> tail(static_cast<size_t>(prefix_size - offset));
+	if (!file || !file.seekg(std::streamoff(offset)) || (!tail.empty() && !file.read(tail.data(), std::streamsize(tail.size())))) {
+		return false;
+	}
+	out = prefix(prefix_size, tail.data());
+	return true;
+}
+
+md5::sum md5_log::digest( void ) const
+{
+	return m_md5.digest();
+}
+
+u64 md5_log::size( void ) const
+{
+	return m_md5.save().message_size;
+}
+
+u64 md5_log::interval( void ) const
+{
+	return m_interval;
+}
+
+bool md5_log::save(const char *path) const
+{
+	const md5::snapshot state = m_md5.save();
+	std::ofstream file(path, std::ios::binary);
+	if (
+		!file.write(LOG_MAGIC, sizeof(LOG_MAGIC)) ||
+		!write_le<u64>(file, m_interval) ||
+		!write_le<u64>(file, state.message_size) ||
+		!file.write(reinterpret_cast<const char*>(state.chunk), state.chunk_size)
+	) {
+		return false;
+	}
+	for (size_t i = 0; i < m_checkpoints.size(); ++i) {
+		if (!write_le<u32>(file, m_checkpoints[i])) {
+			return false;
+		}
+	}
+	// The state words of the log digest are only stored if they are not the last checkpoint.
+	for (u32 i = 0; state.message_size % m_interval != 0 && i < STATE_WORDS; ++i) {
+		if (!write_le<u32>(file, state.state[i])) {
+			return false;
+		}
+	}
+	return bool(file.flush());
+}
+
+bool md5_log::load(const char *path)
+{
+	std::ifstream file(path, std::ios::binary);
+	char magic[sizeof(LOG_MAGIC)];
+	md5::snapshot state;
+	u64 interval;
+	if (
+		!file.read(magic, sizeof(magic)) || memcmp(magic, LOG_MAGIC, sizeof(magic)) != 0 ||
+		!read_le<u64>(file, interval) || interval < CHUNK_BYTESIZE || interval % CHUNK_BYTESIZE != 0 ||
+		!read_le<u64>(file, state.message_size)
+	) {
+		return false;
+	}
+	state.chunk_size = u32(state.message_size % CHUNK_BYTESIZE);
+	if (!file.read(reinterpret_cast<char*>(state.chunk), state.chunk_size)) {
+		return false;
+	}
+	std::vector<u32> checkpoints;
+	for (u64 i = 0; i < (state.message_size / interval + 1) * STATE_WORDS; ++i) { // Grown while reading, so that a corrupt size does not allocate before failing.
+		u32 word;
+		if (!read_le<u32>(file, word)) {
+			return false;
+		}
+		checkpoints.push_back(word);
+	}
+	for (u32 i = 0; i < STATE_WORDS; ++i) {
+		state.state[i] = checkpoints[checkpoints.size() - STATE_WORDS + i];
+		if (state.message_size % interval != 0 && !read_le<u32>(file, state.state[i])) {
+			return false;
+		}
+	}
+	md5 ctx;
+	if (!ctx.restore(state)) {
+		return false;
+	}
+	m_md5 = ctx;
+	m_checkpoints.swap(checkpoints);
+	m_interval = interval;
+	return true;
+}
@@ -0,0 +1,95 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_LOG_H_INCLUDED__
+#define MD5_LOG_H_INCLUDED__
+
+#include <cstdint>
+#include <vector>
+#include "md5.h"
+
+/// The default number of bytes between the checkpoints of a log index.
+constexpr uint64_t MD5_LOG_INTERVAL = 1 << 20;
+
+/// Digests an append-only log while keeping an index of intermediate states at fixed intervals. The digest of any prefix of the log can then be computed by continuing from the nearest preceding checkpoint, digesting at most one interval of the log rather than the whole prefix.
+///
+/// @note Checkpoints fall on chunk boundaries, so each entry of the index only holds the 16 bytes of the state words.
+class md5_log
+{
+private:
+	md5                   m_md5;        // The digest of the whole log so far.
+	std::vector<uint32_t> m_checkpoints; // The state words after each interval, four words per checkpoint.
+	uint64_t              m_interval;
+
+public:
+	/// Creates the index of an empty log.
+	///
+	/// @param interval the number of bytes between checkpoints. Rounded up to a multiple of 64.
+	explicit md5_log(uint64_t interval = MD5_LOG_INTERVAL);
+
+	/// Appends bytes to the log.
+	///
+	/// @param data the bytes.
+	/// @param byte_count the number of bytes.
+	void append(const void *data, uint64_t byte_count);
+
+	/// Returns the offset of the nearest checkpoint at or before the end of a prefix. The bytes of the log from this offset to the end of the prefix are needed to compute the digest of the prefix.
+	///
+	/// @param prefix_size the number of bytes in the prefix. Must not exceed the size of the log.
+	///
+	/// @returns the offset of the checkpoint.
+	uint64_t checkpoint(uint64_t prefix_size) const;
+
+	/// Computes the digest of a prefix of the log.
+	///
+	/// @param prefix_size the number of bytes in the prefix. Must not exceed the size of the log.
+	/// @param tail the bytes of the log from the offset returned by 'checkpoint' up to the end of the prefix.
+	///
+	/// @returns the digest of the prefix.
+	md5::sum prefix(uint64_t prefix_size, const void *tail) const;
+	/// Computes the digest of a prefix of a log file. Only the bytes after the nearest checkpoint are read.
+	///
+	/// @param path the path of the log file.
+	/// @param prefix_size the number of bytes in the prefix. Must not exceed the size of the log.
+	/// @param out the destination of the digest of the prefix.
+	///
+	/// @returns a boolean indicating true if the file could be read, and false otherwise.
+	bool prefix_file(const char *path, uint64_t prefix_size, md5::sum &out) const;
+
+	/// Returns the digest of the whole log.
+	///
+	/// @returns the digest.
+	md5::sum digest( void ) const;
+
+	/// Returns the number of bytes in the log.
+	///
+	/// @returns the number of bytes.
+	uint64_t size( void ) const;
+
+	/// Returns the number of bytes between checkpoints.
+	///
+	/// @returns the interval.
+	uint64_t interval( void ) const;
+
+	/// Writes the index and the state of the log digest to a file, so that appending can resume later.
+	///
+	/// @param path the path of the file.
+	///
+	/// @returns a boolean indicating true if the file was written, and false otherwise.
+	bool save(const char *path) const;
+	/// Replaces the index and the state of the log digest with those read from a file.
+	///
+	/// @param path the path of the file.
+	///
+	/// @returns a boolean indicating true if the file contained a valid index, and false otherwise, in which case the index is left unchanged.
+	bool load(const char *path);
+};
+
+#endif
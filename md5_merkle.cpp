@@ -0,0 +1,135 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#include <algorithm>
+#include <cstring>
+#include "md5_merkle.h"
+#include "md5_parallel.h"
+#include "md5_tree.h"
+
+typedef uint8_t  u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+static constexpr u8 LEAF_PREFIX = 0x00;
+
+/// Digests a node from the level below it. A node without a right child passes the digest of its left child through, which gives the same shape as 'md5_tree'.
+///
+/// @param children the level below the node.
+/// @param i the index of the node in its level.
+///
+/// @returns the digest of the node.
+static md5::sum parent(const std::vector<md5::sum> &children, u64 i)
+{
+	return 2 * i + 1 < children.size() ? md5_tree::node(children[2 * i], children[2 * i + 1]) : children[2 * i];
+}
+
+md5_merkle::md5_merkle(void *buffer, u64 byte_count, u64 leaf_size, u32 thread_count) : m_levels(), m_dirty_bits(), m_dirty(), m_data(reinterpret_cast<u8*>(buffer)), m_byte_count(byte_count), m_leaf_size(leaf_size < 1 ? 1 : leaf_size)
+{
+	const u64 leaf_count = md5_part_count(byte_count, m_leaf_size);
+	m_levels.push_back(std::vector<md5::sum>(static_cast<size_t>(leaf_count)));
+	md5_parts(&LEAF_PREFIX, 1, m_data, byte_count, m_leaf_size, m_levels[0].data(), thread_count);
+	while (m_levels.back().size() > 1) {
+		const std::vector<md5::sum> &children = m_levels.back();
+		std::vector<md5::sum> level((children.size() + 1) / 2);
+		for (size_t i = 0; i < level.size(); ++i) {
+			level[i] = parent(children, i);
+		}
+		m_levels.push_back(level);
+	}
+	m_dirty_bits.resize(static_cast<size_t>((leaf_count + 63) / 64), 0);
+}
+
+void md5_merkle::mark(u64 offset, u64 byte_count)
+{
+	if (offset >= m_byte_count || byte_count == 0) {
+		return;
+	}
+	const u64 end = byte_count < m_byte_count - offset ? offset + byte_count : m_byte_count;
+	for (u64 leaf = offset / m_leaf_size; leaf <= (end - 1) / m_leaf_size; ++leaf) {
+		const u64 bit = u64(1) << (leaf % 64);
+		if ((m_dirty_bits[leaf / 64] & bit) == 0) {
+			m_dirty_bits[leaf / 64] |= bit;
+			m_dirty.push_back(leaf);
+		}
+	}
+}
+
+void md5_merkle::write(u64 offset, const void *data, u64 byte_count)
+{
+	memcpy(m_data + offset, data, static_cast<size_t>(byte_count));
+	mark(offset, byte_count);
+}
+
+const md5::sum &md5_merkle::update( void )
+{
+	if (m_dirty.empty()) {
+		return digest();
+	}
+	std::sort(m_dirty.begin(), m_dirty.end());
+
+	const void *leaves[MD5_LANES];
+	u64 sizes[MD5_LANES];
+	md5::sum sums[MD5_LANES];
+	for (size_t i = 0; i < m_dirty.size(); i += MD5_LANES) {
+		const u32 n = u32((m_dirty.size() - i) < MD5_LANES ? (m_dirty.size() - i) : MD5_LANES);
+		for (u32 j = 0; j < n; ++j) {
+			const u64 offset = m_dirty[i + j] * m_leaf_size;
+			leaves[j] = m_data + offset;
+			sizes[j] = (m_byte_count - offset) < m_leaf_size ? (m_byte_count - offset) : m_leaf_size;
+		}
+		if (n > 1) {
+			md5_batch_prefixed(&LEAF_PREFIX, 1, leaves, sizes, sums, n);
+		} else { // A lone leaf would leave the other lanes idle.
+			sums[0] = md5_tree::leaf(leaves[0], sizes[0]);
+		}
+		for (u32 j = 0; j < n; ++j) {
+			m_levels[0][static_cast<size_t>(m_dirty[i + j])] = sums[j];
+			m_dirty_bits[static_cast<size_t>(m_dirty[i + j] / 64)] &= ~(u64(1) << (m_dirty[i + j] % 64));
+		}
+	}
+
+	// The dirty indices are sorted, so the parents of each level are deduplicated by only comparing neighbours.
+	for (size_t level = 1; level < m_levels.size(); ++level) {
+		size_t count = 0;
+		for (size_t i = 0; i < m_dirty.size(); ++i) {
+			const u64 index = m_dirty[i] / 2;
+			if (count == 0 || m_dirty[count - 1] != index) {
+				m_dirty[count++] = index;
+			}
+		}
+		m_dirty.resize(count);
+		for (size_t i = 0; i < m_dirty.size(); ++i) {
+			m_levels[level][static_cast<size_t>(m_dirty[i])] = parent(m_levels[level - 1], m_dirty[i]);
+		}
+	}
+	m_dirty.clear();
+	return digest();
+}
+
+const md5::sum &md5_merkle::digest( void ) const
+{
+	return m_levels.back()[0];
+}
+
+u64 md5_merkle::leaf_count( void ) const
+{
+	return u64(m_levels[0].size());
+}
+
+u64 md5_merkle::dirty_count( void ) const
+{
+	return u64(m_dirty.size());
+}
+
+u64 md5_merkle::leaf_size( void ) const
+{
+	return m_leaf_size;
+}
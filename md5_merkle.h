@@ -0,0 +1,80 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_MERKLE_H_INCLUDED__
+#define MD5_MERKLE_H_INCLUDED__
+
+#include <cstdint>
+#include <vector>
+#include "md5.h"
+
+/// The default number of bytes in each leaf of an incremental tree digest.
+constexpr uint64_t MD5_MERKLE_LEAF_SIZE = 64 << 10;
+
+/// Keeps the tree digest of a mutable buffer up to date. Modified byte ranges are marked as dirty, and updating the digest only digests the dirty leaves and the nodes on their paths to the root, so the cost of an update scales with the size of the change rather than the size of the buffer.
+///
+/// @note The digest is the same as the digest computed by 'md5_tree' with the same leaf size.
+/// @note Modifications must be marked explicitly, either with 'mark' or by writing through 'write'. The buffer must stay alive and must not be resized while it is tracked.
+class md5_merkle
+{
+private:
+	std::vector< std::vector<md5::sum> > m_levels;      // The digests of the leaves, followed by each level of nodes up to the root.
+	std::vector<uint64_t>                m_dirty_bits;  // A bit for each leaf, set if the leaf is dirty.
+	std::vector<uint64_t>                m_dirty;       // The indices of the dirty leaves.
+	uint8_t                             *m_data;
+	uint64_t                             m_byte_count;
+	uint64_t                             m_leaf_size;
+
+public:
+	/// Starts tracking a buffer and computes its digest.
+	///
+	/// @param buffer the buffer.
+	/// @param byte_count the number of bytes in the buffer.
+	/// @param leaf_size the number of bytes in each leaf. At least 1.
+	/// @param thread_count the number of threads to digest the leaves with initially. Zero uses the number of hardware threads.
+	md5_merkle(void *buffer, uint64_t byte_count, uint64_t leaf_size = MD5_MERKLE_LEAF_SIZE, uint32_t thread_count = 0);
+
+	/// Marks a range of the buffer as modified. The range is clamped to the buffer.
+	///
+	/// @param offset the offset of the first modified byte.
+	/// @param byte_count the number of modified bytes.
+	void mark(uint64_t offset, uint64_t byte_count);
+	/// Copies bytes into the buffer and marks them as modified.
+	///
+	/// @param offset the offset in the buffer to copy to. The bytes must fit in the buffer.
+	/// @param data the bytes to copy.
+	/// @param byte_count the number of bytes to copy.
+	void write(uint64_t offset, const void *data, uint64_t byte_count);
+
+	/// Digests the dirty leaves in lock-step with 'md5_batch', and then the nodes above them.
+	///
+	/// @returns the up-to-date digest of the buffer.
+	const md5::sum &update( void );
+
+	/// Returns the digest of the buffer as of the last update.
+	///
+	/// @returns the digest.
+	const md5::sum &digest( void ) const;
+
+	/// Returns the number of leaves.
+	///
+	/// @returns the number of leaves.
+	uint64_t leaf_count( void ) const;
+	/// Returns the number of leaves marked as dirty since the last update.
+	///
+	/// @returns the number of dirty leaves.
+	uint64_t dirty_count( void ) const;
+	/// Returns the number of bytes in each leaf.
+	///
+	/// @returns the leaf size.
+	uint64_t leaf_size( void ) const;
+};
+
+#endif
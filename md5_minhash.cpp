@@ -0,0 +1,167 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#include <algorithm>
+#include <cstring>
+#include "md5.h"
+#include "md5_minhash.h"
+#include "md5_io.h"
+
+typedef uint8_t  u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+static constexpr u32 BLOCK_SIZE = 64;
+
+/// Lowers the signature words to the permutations of a set of shingle digests where they are smaller.
+///
+/// @param states the final states of the shingles, which are the words of their digests.
+/// @param lane_count the number of shingles.
+/// @param signature the signature to update.
+/// @param hash_count the number of words in the signature.
+static void update(const u32 (*states)[4], u32 lane_count, u32 *signature, u32 hash_count)
+{
+	for (u32 l = 0; l < lane_count; ++l) {
+		const u32 base = states[l][0] ^ states[l][2];
+		const u32 step = (states[l][1] ^ states[l][3]) | 1; // Odd, so that no two permutations of a shingle are equal.
+		for (u32 i = 0; i < hash_count; ++i) { // Every iteration is independent, which lets the compiler vectorize the loop.
+			const u32 v = base + i * step;
+			signature[i] = v < signature[i] ? v : signature[i];
+		}
+	}
+}
+
+md5_minhash::md5_minhash(u32 shingle_size, u32 hash_count) :
+	m_shingle_size(shingle_size < 1 ? 1 : (shingle_size > MD5_MINHASH_MAX_SHINGLE_SIZE ? MD5_MINHASH_MAX_SHINGLE_SIZE : shingle_size)),
+	m_hash_count(hash_count < 1 ? 1 : hash_count)
+{}
+
+void md5_minhash::signature(const void *document, u64 byte_count, u32 *out) const
+{
+	for (u32 i = 0; i < m_hash_count; ++i) {
+		out[i] = 0xffffffff;
+	}
+	if (byte_count == 0) {
+		return;
+	}
+
+	const u8 *bytes = reinterpret_cast<const u8*>(document);
+	const u32 size = byte_count < m_shingle_size ? u32(byte_count) : m_shingle_size;
+	const u64 shingle_count = byte_count - size + 1;
+
+	// The padding of each lane block is written once, after which only the shingle bytes change.
+	u8 blocks[MD5_LANES][BLOCK_SIZE];
+	const void *block_ptrs[MD5_LANES];
+	u32 iv[4];
+	u32 states[MD5_LANES][4];
+	u32 *state_ptrs[MD5_LANES];
+	memset(blocks, 0, sizeof(blocks));
+	md5_init(iv);
+	for (u32 l = 0; l < MD5_LANES; ++l) {
+		blocks[l][size] = 0x80;
+		const u64 bit_count = u64(size) * 8;
+		for (u32 i = 0; i < 8; ++i) {
+			blocks[l][BLOCK_SIZE - 8 + i] = u8(bit_count >> (i * 8));
+		}
+		block_ptrs[l] = blocks[l];
+		state_ptrs[l] = states[l];
+	}
+
+	for (u64 s = 0; s < shingle_count; s += MD5_LANES) {
+		const u32 lane_count = u32((shingle_count - s) < MD5_LANES ? (shingle_count - s) : MD5_LANES);
+		for (u32 l = 0; l < lane_count; ++l) {
+			memcpy(blocks[l], bytes + s + l, size);
+			memcpy(states[l], iv, sizeof(iv));
+		}
+		md5_compress_lanes(state_ptrs, block_ptrs, lane_count);
+		update(states, lane_count, out, m_hash_count);
+	}
+}
+
+u32 md5_minhash::shingle_size( void ) const
+{
+	return m_shingle_size;
+}
+
+u32 md5_minhash::hash_count( void ) const
+{
+	return m_hash_count;
+}
+
+double md5_minhash::similarity(const u32 *a, const u32 *b, u32 hash_count)
+{
+	u32 equal = 0;
+	for (u32 i = 0; i < hash_count; ++i) {
+		equal += a[i] == b[i] ? 1 : 0;
+	}
+	return hash_count > 0 ? double(equal) / hash_count : 0.0;
+}
+
+void md5_lsh::keys(const u32 *signature, u64 *out) const
+{
+	const u32 band_count = u32(m_bands.size());
+	const u64 band_size = u64(m_rows) * sizeof(u32);
+
+	// Rows are serialized in little endian order so that keys do not depend on the host.
+	std::vector<u8> rows(size_t(band_count * band_size));
+	for (u32 i = 0; i < band_count * m_rows; ++i) {
+		for (u32 j = 0; j < sizeof(u32); ++j) {
+			rows[i * sizeof(u32) + j] = u8(signature[i] >> (j * 8));
+		}
+	}
+	std::vector<const void*> messages(band_count);
+	std::vector<u64> byte_counts(band_count, band_size);
+	std::vector<md5::sum> sums(band_count);
+	for (u32 b = 0; b < band_count; ++b) {
+		messages[b] = rows.data() + b * band_size;
+	}
+	md5_batch(messages.data(), byte_counts.data(), sums.data(), band_count);
+
+	for (u32 b = 0; b < band_count; ++b) {
+		out[b] = decode_le<u64>(sums[b]);
+	}
+}
+
+md5_lsh::md5_lsh(u32 band_count, u32 rows_per_band) : m_bands(band_count < 1 ? 1 : band_count), m_rows(rows_per_band < 1 ? 1 : rows_per_band)
+{}
+
+void md5_lsh::insert(const u32 *signature, u32 id)
+{
+	std::vector<u64> band_keys(m_bands.size());
+	keys(signature, band_keys.data());
+	for (size_t b = 0; b < m_bands.size(); ++b) {
+		m_bands[b][band_keys[b]].push_back(id);
+	}
+}
+
+void md5_lsh::candidates(const u32 *signature, std::vector<u32> &out) const
+{
+	out.clear();
+	std::vector<u64> band_keys(m_bands.size());
+	keys(signature, band_keys.data());
+	for (size_t b = 0; b < m_bands.size(); ++b) {
+		const auto bucket = m_bands[b].find(band_keys[b]);
+		if (bucket != m_bands[b].end()) {
+			out.insert(out.end(), bucket->second.begin(), bucket->second.end());
+		}
+	}
+	std::sort(out.begin(), out.end());
+	out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+u32 md5_lsh::band_count( void ) const
+{
+	return u32(m_bands.size());
+}
+
+u32 md5_lsh::rows_per_band( void ) const
+{
+	return m_rows;
+}
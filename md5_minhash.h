@@ -0,0 +1,111 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_MINHASH_H_INCLUDED__
+#define MD5_MINHASH_H_INCLUDED__
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/// The largest shingle size, in bytes, supported by 'md5_minhash'. Shingles up to this size fit into a single padded message block.
+constexpr uint32_t MD5_MINHASH_MAX_SHINGLE_SIZE = 55;
+
+/// Computes MinHash signatures of documents from the MD5 digests of their overlapping, fixed-size shingles. The signature estimates the Jaccard similarity between the shingle sets of two documents.
+///
+/// @note Each shingle fits in one message block, so shingles are hashed MD5_LANES at a time with 'md5_compress_lanes' on blocks that are padded once in advance.
+/// @note The permutations are derived by double hashing, with a base and a step folded from the words of each digest, so any number of permutations costs one digest per shingle.
+class md5_minhash
+{
+private:
+	uint32_t m_shingle_size;
+	uint32_t m_hash_count;
+
+public:
+	/// Creates a signature engine.
+	///
+	/// @param shingle_size the number of bytes in each shingle. Clamped to [1, MD5_MINHASH_MAX_SHINGLE_SIZE].
+	/// @param hash_count the number of permutations, which is the number of words in a signature. At least 1.
+	explicit md5_minhash(uint32_t shingle_size = 8, uint32_t hash_count = 128);
+
+	/// Computes the signature of a document. A document shorter than the shingle size is treated as a single shingle.
+	///
+	/// @param document the document.
+	/// @param byte_count the number of bytes in the document.
+	/// @param out the destination signature of 'hash_count' words. All words are 0xffffffff for an empty document.
+	void signature(const void *document, uint64_t byte_count, uint32_t *out) const;
+
+	/// Returns the number of bytes in each shingle.
+	///
+	/// @returns the shingle size.
+	uint32_t shingle_size( void ) const;
+
+	/// Returns the number of words in a signature.
+	///
+	/// @returns the number of permutations.
+	uint32_t hash_count( void ) const;
+
+	/// Estimates the Jaccard similarity between two documents from their signatures.
+	///
+	/// @param a the signature of the first document.
+	/// @param b the signature of the second document.
+	/// @param hash_count the number of words in each signature.
+	///
+	/// @returns the fraction of words that are equal in both signatures.
+	static double similarity(const uint32_t *a, const uint32_t *b, uint32_t hash_count);
+};
+
+/// An index of MinHash signatures using locality-sensitive hashing. Signatures are split into bands of consecutive rows, and two documents become candidates if all rows of at least one band are equal.
+///
+/// @note The rows of each band are keyed by the first 64 bits of their MD5 digest.
+class md5_lsh
+{
+private:
+	std::vector< std::unordered_map< uint64_t, std::vector<uint32_t> > > m_bands;
+	uint32_t                                                             m_rows;
+
+private:
+	/// Computes the key of each band of a signature.
+	///
+	/// @param signature the signature.
+	/// @param out the destination key of each band.
+	void keys(const uint32_t *signature, uint64_t *out) const;
+
+public:
+	/// Creates an empty index.
+	///
+	/// @param band_count the number of bands. At least 1.
+	/// @param rows_per_band the number of signature words in each band. At least 1. Signatures must have at least 'band_count * rows_per_band' words.
+	md5_lsh(uint32_t band_count, uint32_t rows_per_band);
+
+	/// Adds a document to the index.
+	///
+	/// @param signature the signature of the document.
+	/// @param id the identifier of the document.
+	void insert(const uint32_t *signature, uint32_t id);
+
+	/// Finds the documents sharing at least one band with a signature.
+	///
+	/// @param signature the signature.
+	/// @param out the destination of the candidate identifiers, sorted and without duplicates. Cleared before writing.
+	void candidates(const uint32_t *signature, std::vector<uint32_t> &out) const;
+
+	/// Returns the number of bands.
+	///
+	/// @returns the number of bands.
+	uint32_t band_count( void ) const;
+
+	/// Returns the number of signature words in each band.
+	///
+	/// @returns the number of rows.
+	uint32_t rows_per_band( void ) const;
+};
+
+#endif
@@ -0,0 +1,120 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#include "md5_ordered_sink.h"
+
+typedef uint8_t  u8;
+typedef uint64_t u64;
+
+void md5_ordered_sink::run( void )
+{
+	std::unique_lock<std::mutex> guard(m_lock);
+	for (;;) {
+		m_work.wait(guard, [this]() { return !m_ready.empty() || m_closed; });
+		if (m_ready.empty()) {
+			return;
+		}
+		std::vector<u8> segment = std::move(m_ready.front());
+		m_ready.pop_front();
+		guard.unlock();
+		m_md5.ingest(segment.data(), segment.size());
+		guard.lock();
+		m_buffered -= segment.size();
+		m_space.notify_all();
+	}
+}
+
+void md5_ordered_sink::accept(u64 offset, std::vector<u8> &&segment)
+{
+	m_buffered += segment.size();
+	if (offset != m_frontier) {
+		m_pending[offset] = std::move(segment);
+		return;
+	}
+
+	// The segment continues the message, and may be followed by pending segments that now do too.
+	m_frontier += segment.size();
+	m_ready.push_back(std::move(segment));
+	for (auto next = m_pending.begin(); next != m_pending.end() && next->first == m_frontier; next = m_pending.erase(next)) {
+		m_frontier += next->second.size();
+		m_ready.push_back(std::move(next->second));
+	}
+	m_work.notify_one();
+	m_space.notify_all(); // Producers waiting on the new frontier may now be admitted.
+}
+
+bool md5_ordered_sink::admit(std::unique_lock<std::mutex> &guard, u64 offset, u64 byte_count)
+{
+	for (;;) {
+		if (m_closed || offset < m_frontier) {
+			return false;
+		}
+		auto next = m_pending.lower_bound(offset);
+		if ((next != m_pending.end() && (next->first == offset || next->first < offset + byte_count)) || (next != m_pending.begin() && std::prev(next)->first + std::prev(next)->second.size() > offset)) {
+			return false;
+		}
+		if (offset == m_frontier || m_buffered == 0 || m_buffered + byte_count <= m_capacity) {
+			return true;
+		}
+		m_space.wait(guard);
+	}
+}
+
+md5_ordered_sink::md5_ordered_sink(u64 capacity) : m_pending(), m_ready(), m_lock(), m_space(), m_work(), m_md5(), m_hasher(), m_frontier(0), m_buffered(0), m_capacity(capacity), m_closed(false)
+{
+	m_hasher = std::thread(&md5_ordered_sink::run, this);
+}
+
+md5_ordered_sink::~md5_ordered_sink( void )
+{
+	md5::sum unused;
+	finish(unused);
+}
+
+bool md5_ordered_sink::write(u64 offset, const void *data, u64 byte_count)
+{
+	const u8 *bytes = reinterpret_cast<const u8*>(data);
+	return write(offset, std::vector<u8>(bytes, bytes + byte_count)); // Copied before taking the lock, so that other producers are not stalled by the copy.
+}
+
+bool md5_ordered_sink::write(u64 offset, std::vector<u8> &&segment)
+{
+	if (segment.empty()) {
+		return true;
+	}
+	std::unique_lock<std::mutex> guard(m_lock);
+	if (!admit(guard, offset, segment.size())) {
+		return false;
+	}
+	accept(offset, std::move(segment));
+	return true;
+}
+
+bool md5_ordered_sink::finish(md5::sum &out)
+{
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+		m_closed = true;
+	}
+	m_work.notify_one();
+	m_space.notify_all();
+	if (m_hasher.joinable()) {
+		m_hasher.join();
+	}
+	out = m_md5.digest();
+	std::lock_guard<std::mutex> guard(m_lock);
+	return m_pending.empty();
+}
+
+u64 md5_ordered_sink::frontier( void )
+{
+	std::lock_guard<std::mutex> guard(m_lock);
+	return m_frontier;
+}
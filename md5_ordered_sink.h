@@ -0,0 +1,103 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_ORDERED_SINK_H_INCLUDED__
+#define MD5_ORDERED_SINK_H_INCLUDED__
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "md5.h"
+
+/// The default number of bytes a sink buffers before producers are made to wait.
+constexpr uint64_t MD5_SINK_CAPACITY = 64 << 20;
+
+/// Computes the digest of a message whose segments arrive out of order from several threads. Segments that arrive ahead of the next expected byte are held in a reorder buffer, and contiguous runs are digested on a dedicated thread as soon as they become available.
+///
+/// @note The reorder buffer is bounded. A producer whose segment does not fit waits until space is freed, except for the segment the digest is waiting for, which is always accepted. Producers must therefore claim segments in increasing order of offset, so that the segment the digest is waiting for is always being produced by a thread that is not waiting for space, or the capacity must cover the largest distance at which segments are reordered.
+class md5_ordered_sink
+{
+private:
+	std::map< uint64_t, std::vector<uint8_t> > m_pending;  // Segments ahead of the frontier, by offset.
+	std::deque< std::vector<uint8_t> >         m_ready;    // Contiguous segments waiting to be digested, in order.
+	std::mutex                                 m_lock;
+	std::condition_variable                    m_space;    // Signalled when buffered bytes are digested or the frontier advances.
+	std::condition_variable                    m_work;     // Signalled when segments become ready or the sink is closed.
+	md5                                        m_md5;      // Only accessed by the hashing thread until it has been joined.
+	std::thread                                m_hasher;
+	uint64_t                                   m_frontier; // The offset of the first byte that has not been made ready.
+	uint64_t                                   m_buffered; // The number of bytes in pending and ready segments, including the segment being digested.
+	uint64_t                                   m_capacity;
+	bool                                       m_closed;
+
+private:
+	/// Digests ready segments until the sink is closed and no ready segments remain.
+	void run( void );
+
+	/// Accepts a segment. Must be called while holding the lock.
+	///
+	/// @param offset the offset of the segment.
+	/// @param segment the bytes of the segment.
+	void accept(uint64_t offset, std::vector<uint8_t> &&segment);
+
+	/// Waits until a segment can be accepted. Must be called while holding the lock.
+	///
+	/// @param guard the held lock.
+	/// @param offset the offset of the segment.
+	/// @param byte_count the number of bytes in the segment.
+	///
+	/// @returns a boolean indicating true if the segment can be accepted, and false if it overlaps bytes already accepted, starts at the offset of a pending segment, or the sink has been closed.
+	bool admit(std::unique_lock<std::mutex> &guard, uint64_t offset, uint64_t byte_count);
+
+public:
+	/// Creates a sink and starts its hashing thread.
+	///
+	/// @param capacity the number of bytes that may be buffered before producers wait.
+	explicit md5_ordered_sink(uint64_t capacity = MD5_SINK_CAPACITY);
+	/// Closes the sink and stops its hashing thread.
+	~md5_ordered_sink( void );
+
+	md5_ordered_sink(const md5_ordered_sink&) = delete;
+	md5_ordered_sink &operator=(const md5_ordered_sink&) = delete;
+
+	/// Adds a segment of the message. The bytes are copied. Empty segments are ignored. Thread-safe.
+	///
+	/// @param offset the offset of the segment in the message.
+	/// @param data the bytes of the segment.
+	/// @param byte_count the number of bytes in the segment.
+	///
+	/// @returns a boolean indicating true if the segment was accepted, and false if it overlaps bytes already accepted or the sink has been closed.
+	bool write(uint64_t offset, const void *data, uint64_t byte_count);
+	/// Adds a segment of the message, taking ownership of its bytes. Empty segments are ignored. Thread-safe.
+	///
+	/// @param offset the offset of the segment in the message.
+	/// @param segment the bytes of the segment.
+	///
+	/// @returns a boolean indicating true if the segment was accepted, and false if it overlaps bytes already accepted or the sink has been closed.
+	bool write(uint64_t offset, std::vector<uint8_t> &&segment);
+
+	/// Closes the sink, waits until all contiguous bytes have been digested, and returns the digest. Segments written afterwards are rejected.
+	///
+	/// @param out the destination of the digest of the message.
+	///
+	/// @returns a boolean indicating true if the message had no gaps, and false otherwise.
+	bool finish(md5::sum &out);
+
+	/// Returns the number of bytes of the message that have been received in order, and have been or are about to be digested.
+	///
+	/// @returns the number of bytes.
+	uint64_t frontier( void );
+};
+
+#endif
@@ -0,0 +1,169 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#include <atomic>
+#include <fstream>
+#include <thread>
+#include "md5_parallel.h"
+
+typedef uint8_t  u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+static constexpr u64 READ_BYTESIZE = 1 << 20; // The number of bytes read from a file at a time.
+
+/// Runs a job on several threads. Each thread repeatedly claims the next unprocessed part until all parts are claimed.
+///
+/// @param part_count the number of parts.
+/// @param thread_count the number of threads to use. Zero uses the number of hardware threads.
+/// @param make_job creates the job a thread runs for each part it claims. The job returns false on failure. Each thread creates its own job, so that jobs can keep resources, such as an open file, between parts.
+///
+/// @returns a boolean indicating true if the job succeeded for all parts, and false otherwise.
+template < typename make_job_t >
+static bool run_parts(u64 part_count, u32 thread_count, const make_job_t &make_job)
+{
+	if (thread_count == 0) {
+		thread_count = std::thread::hardware_concurrency();
+	}
+	if (u64(thread_count) > part_count) {
+		thread_count = u32(part_count);
+	}
+
+	std::atomic<u64>  next_part(0);
+	std::atomic<bool> success(true);
+	auto worker = [&]() {
+		auto job = make_job();
+		for (u64 part = next_part++; part < part_count && success; part = next_part++) {
+			if (!job(part)) {
+				success = false;
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (u32 i = 1; i < thread_count; ++i) {
+		threads.emplace_back(worker);
+	}
+	worker(); // The calling thread also does work.
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+	return success;
+}
+
+/// Digests parts of a file. Each thread has its own reader, so the file is opened once per thread rather than once per part.
+class part_reader
+{
+private:
+	std::ifstream          m_file;
+	std::vector<char>      m_buffer;
+	u64                    m_byte_count;
+	u64                    m_part_size;
+	std::vector<md5::sum> *m_out;
+
+public:
+	/// Opens the file.
+	///
+	/// @param path the path of the file.
+	/// @param byte_count the number of bytes in the file.
+	/// @param part_size the number of bytes in each part.
+	/// @param out the destination of the part digests.
+	part_reader(const char *path, u64 byte_count, u64 part_size, std::vector<md5::sum> &out) :
+		m_file(path, std::ios::binary), m_buffer(size_t(part_size < READ_BYTESIZE ? part_size : READ_BYTESIZE)), m_byte_count(byte_count), m_part_size(part_size), m_out(&out)
+	{}
+
+	/// Digests a part.
+	///
+	/// @param part the index of the part.
+	///
+	/// @returns a boolean indicating true if the part was read, and false otherwise.
+	bool operator()(u64 part)
+	{
+		const u64 offset = part * m_part_size;
+		u64 remaining = (m_byte_count - offset) < m_part_size ? (m_byte_count - offset) : m_part_size;
+		if (!m_file || !m_file.seekg(std::streamoff(offset))) {
+			return false;
+		}
+		md5 ctx;
+		while (remaining > 0) {
+			const u64 read_size = remaining < m_buffer.size() ? remaining : m_buffer.size();
+			if (!m_file.read(m_buffer.data(), std::streamsize(read_size))) {
+				return false;
+			}
+			ctx.ingest(m_buffer.data(), read_size);
+			remaining -= read_size;
+		}
+		(*m_out)[size_t(part)] = ctx.digest();
+		return true;
+	}
+};
+
+u64 md5_part_count(u64 byte_count, u64 part_size)
+{
+	part_size = part_size < 1 ? 1 : part_size;
+	return byte_count > 0 ? (byte_count + part_size - 1) / part_size : 1;
+}
+
+void md5_parts(const void *message, u64 byte_count, u64 part_size, md5::sum *out, u32 thread_count)
+{
+	md5_parts(nullptr, 0, message, byte_count, part_size, out, thread_count);
+}
+
+void md5_parts(const void *prefix, u64 prefix_size, const void *message, u64 byte_count, u64 part_size, md5::sum *out, u32 thread_count)
+{
+	const u8 *msg = reinterpret_cast<const u8*>(message);
+	part_size = part_size < 1 ? 1 : part_size;
+	const u64 part_count = md5_part_count(byte_count, part_size);
+	if (thread_count == 0) {
+		thread_count = std::thread::hardware_concurrency();
+	}
+
+	// Each job digests a group of parts in lock-step, but groups are kept small enough for every thread to get work.
+	const u64 threads = thread_count > 0 ? thread_count : 1;
+	const u64 group_size = part_count / threads < 1 ? 1 : (part_count / threads < MD5_LANES ? part_count / threads : MD5_LANES);
+	run_parts((part_count + group_size - 1) / group_size, thread_count, [&]() {
+		return [&](u64 group) {
+			const void *parts[MD5_LANES];
+			u64 sizes[MD5_LANES];
+			const u64 first = group * group_size;
+			const u64 count = (part_count - first) < group_size ? (part_count - first) : group_size;
+			for (u64 i = 0; i < count; ++i) {
+				const u64 offset = (first + i) * part_size;
+				parts[i] = msg + offset;
+				sizes[i] = (byte_count - offset) < part_size ? (byte_count - offset) : part_size;
+			}
+			md5_batch_prefixed(prefix, prefix_size, parts, sizes, out + first, count);
+			return true;
+		};
+	});
+}
+
+bool md5_parts_file(const char *path, u64 part_size, std::vector<md5::sum> &out, u32 thread_count)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file) {
+		return false;
+	}
+	const std::streamoff end = file.tellg();
+	if (end < 0) {
+		return false;
+	}
+	const u64 byte_count = u64(end);
+	file.close();
+	part_size = part_size < 1 ? 1 : part_size;
+	if (md5_part_count(byte_count, part_size) > u64(out.max_size())) {
+		return false; // Not a regular file, or too many parts to store.
+	}
+
+	out.resize(size_t(md5_part_count(byte_count, part_size)));
+	return run_parts(out.size(), thread_count, [&]() {
+		return part_reader(path, byte_count, part_size, out);
+	});
+}
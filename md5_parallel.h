@@ -0,0 +1,56 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_PARALLEL_H_INCLUDED__
+#define MD5_PARALLEL_H_INCLUDED__
+
+#include <cstdint>
+#include <vector>
+#include "md5.h"
+
+/// Returns the number of parts a message is split into by 'md5_parts'. An empty message consists of a single empty part.
+///
+/// @param byte_count the number of bytes in the message.
+/// @param part_size the number of bytes in each part. Zero is treated as one.
+///
+/// @returns the number of parts.
+uint64_t md5_part_count(uint64_t byte_count, uint64_t part_size);
+
+/// Splits a message into consecutive parts of a fixed size and computes the digest of each part. Parts are distributed over several threads, each processing up to MD5_LANES parts at a time in lock-step with 'md5_batch'.
+///
+/// @param message the message.
+/// @param byte_count the number of bytes in the message.
+/// @param part_size the number of bytes in each part. The last part may be shorter. Zero is treated as one.
+/// @param out the destination of the digest of each part. Must fit 'md5_part_count' digests.
+/// @param thread_count the number of threads to use. Zero uses the number of hardware threads.
+void md5_parts(const void *message, uint64_t byte_count, uint64_t part_size, md5::sum *out, uint32_t thread_count = 0);
+
+/// Splits a message into consecutive parts of a fixed size and computes the digest of a common prefix followed by each part. Used for constructions that separate the digests of parts from other digests, such as tree hashing.
+///
+/// @param prefix the prefix of every part.
+/// @param prefix_size the number of bytes in the prefix.
+/// @param message the message.
+/// @param byte_count the number of bytes in the message.
+/// @param part_size the number of bytes in each part. The last part may be shorter. Zero is treated as one.
+/// @param out the destination of the digest of each prefixed part. Must fit 'md5_part_count' digests.
+/// @param thread_count the number of threads to use. Zero uses the number of hardware threads.
+void md5_parts(const void *prefix, uint64_t prefix_size, const void *message, uint64_t byte_count, uint64_t part_size, md5::sum *out, uint32_t thread_count = 0);
+
+/// Splits a file into consecutive parts of a fixed size and computes the digest of each part. Parts are distributed over several threads, each reading and processing one part at a time.
+///
+/// @param path the path of the file.
+/// @param part_size the number of bytes in each part. The last part may be shorter. Zero is treated as one.
+/// @param out the destination of the digest of each part.
+/// @param thread_count the number of threads to use. Zero uses the number of hardware threads.
+///
+/// @returns a boolean indicating true if the file could be sized and read in full, and false otherwise.
+bool md5_parts_file(const char *path, uint64_t part_size, std::vector<md5::sum> &out, uint32_t thread_count = 0);
+
+#endif
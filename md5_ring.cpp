@@ -0,0 +1,161 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#include <algorithm>
+#include <cstring>
+#include "md5.h"
+#include "md5_ring.h"
+
+typedef uint8_t  u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+static constexpr u32 POINTS_PER_DIGEST = 4;   // Each digest is split into four 32-bit points.
+static constexpr u32 MAX_LABEL_SIZE    = 256; // Server names are truncated to fit labels of this size.
+static constexpr u32 BATCH_SIZE        = MD5_LANES * 8; // The number of labels hashed per call to 'md5_batch'.
+
+/// Reads a point from a digest in little endian order.
+///
+/// @param digest the digest.
+/// @param i the index of the point within the digest.
+///
+/// @returns the point.
+static u32 point_at(const u8 *digest, u32 i)
+{
+	return
+		(u32(digest[i * 4 + 3]) << 24) | (u32(digest[i * 4 + 2]) << 16) |
+		(u32(digest[i * 4 + 1]) << 8)  |  u32(digest[i * 4]);
+}
+
+u32 md5_ring::layout(const std::vector<u64> &sorted, u32 i, u32 k)
+{
+	if (k <= sorted.size()) {
+		i = layout(sorted, i, 2 * k);
+		m_points[k]  = u32(sorted[i] >> 32);
+		m_servers[k] = u32(sorted[i]);
+		if (i == 0) {
+			m_first = k;
+		}
+		++i;
+		i = layout(sorted, i, 2 * k + 1);
+	}
+	return i;
+}
+
+md5_ring::md5_ring( void ) : m_points(), m_servers(), m_first(0)
+{}
+
+md5_ring::md5_ring(const char *const *servers, u32 server_count, u32 points_per_server) : md5_ring()
+{
+	build(servers, server_count, points_per_server);
+}
+
+void md5_ring::build(const char *const *servers, u32 server_count, u32 points_per_server)
+{
+	const u32 labels_per_server = (points_per_server + POINTS_PER_DIGEST - 1) / POINTS_PER_DIGEST;
+	const u64 label_count = u64(server_count) * labels_per_server;
+
+	// Points are packed with their server as (point << 32 | server), so that sorting orders by point and then by server.
+	std::vector<u64> sorted;
+	sorted.reserve(size_t(label_count * POINTS_PER_DIGEST));
+
+	char labels[BATCH_SIZE][MAX_LABEL_SIZE];
+	const void *messages[BATCH_SIZE];
+	u64 sizes[BATCH_SIZE];
+	u32 owners[BATCH_SIZE];
+	md5::sum sums[BATCH_SIZE];
+	u32 n = 0;
+	for (u64 label = 0; label < label_count; ++label) {
+		const u32 server = u32(label / labels_per_server);
+		const u32 replica = u32(label % labels_per_server);
+
+		// Print 'server-replica' into the label.
+		char digits[10];
+		u32 digit_count = 0;
+		u32 r = replica;
+		do {
+			digits[digit_count++] = char('0' + r % 10);
+			r /= 10;
+		} while (r > 0);
+		size_t name_size = strlen(servers[server]);
+		if (name_size > MAX_LABEL_SIZE - sizeof(digits) - 1) {
+			name_size = MAX_LABEL_SIZE - sizeof(digits) - 1;
+		}
+		char *out = labels[n];
+		memcpy(out, servers[server], name_size);
+		out += name_size;
+		*out++ = '-';
+		while (digit_count > 0) {
+			*out++ = digits[--digit_count];
+		}
+
+		messages[n] = labels[n];
+		sizes[n] = u64(out - labels[n]);
+		owners[n] = server;
+		++n;
+
+		if (n == BATCH_SIZE || label + 1 == label_count) {
+			md5_batch(messages, sizes, sums, n);
+			for (u32 i = 0; i < n; ++i) {
+				for (u32 p = 0; p < POINTS_PER_DIGEST; ++p) {
+					sorted.push_back((u64(point_at(sums[i], p)) << 32) | owners[i]);
+				}
+			}
+			n = 0;
+		}
+	}
+	std::sort(sorted.begin(), sorted.end());
+
+	m_points.assign(sorted.size() + 1, 0);
+	m_servers.assign(sorted.size() + 1, 0);
+	m_first = 0;
+	layout(sorted, 0, 1);
+}
+
+u32 md5_ring::lookup(const char *key) const
+{
+	return lookup(key, u64(strlen(key)));
+}
+
+u32 md5_ring::lookup(const void *key, u64 byte_count) const
+{
+	return lookup_point(point_of(key, byte_count));
+}
+
+u32 md5_ring::lookup_point(u32 point) const
+{
+	if (m_points.size() <= 1) {
+		return MD5_RING_EMPTY;
+	}
+	// Branch-free lower bound over the Eytzinger layout. The path taken is encoded in the bits of 'k', and the answer is the last node where the search went left.
+	const u32 n = u32(m_points.size() - 1);
+	u32 k = 1;
+	while (k <= n) {
+		k = 2 * k + (m_points[k] < point ? 1 : 0);
+	}
+	while ((k & 1) != 0) {
+		k >>= 1;
+	}
+	k >>= 1;
+	return m_servers[k != 0 ? k : m_first];
+}
+
+u32 md5_ring::point_of(const void *key, u64 byte_count)
+{
+	// Finalizing directly from the initial state avoids copying the key into the chunk buffer of an md5 object.
+	u32 iv[4];
+	md5_init(iv);
+	return point_at(md5_finalize(iv, key, byte_count, byte_count), 0);
+}
+
+u32 md5_ring::point_count( void ) const
+{
+	return m_points.empty() ? 0 : u32(m_points.size() - 1);
+}
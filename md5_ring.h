@@ -0,0 +1,91 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_RING_H_INCLUDED__
+#define MD5_RING_H_INCLUDED__
+
+#include <cstdint>
+#include <vector>
+
+/// Returned by lookups on a ring without points.
+constexpr uint32_t MD5_RING_EMPTY = ~uint32_t(0);
+
+/// A Ketama-compatible consistent hashing ring. Each server is placed on the ring at points derived from the MD5 digests of the labels 'server-0', 'server-1', and so on, where each digest yields four points. A key is assigned to the server of the first point at or after the digest of the key, wrapping around at the end of the ring.
+///
+/// @note Points are stored in a flat array in Eytzinger (breadth-first) order, which makes the branch-free binary search of lookups cache friendly.
+class md5_ring
+{
+private:
+	std::vector<uint32_t> m_points;  // Ring points in Eytzinger order, one-based.
+	std::vector<uint32_t> m_servers; // The server of each point, in the same order as 'm_points'.
+	uint32_t              m_first;   // The index of the smallest point, used when wrapping around.
+
+private:
+	/// Lays out a sorted range of points in Eytzinger order.
+	///
+	/// @param sorted the points sorted by value, paired with their servers.
+	/// @param i the next sorted index to place.
+	/// @param k the Eytzinger index to place it at.
+	///
+	/// @returns the next sorted index to place.
+	uint32_t layout(const std::vector<uint64_t> &sorted, uint32_t i, uint32_t k);
+
+public:
+	/// Default constructor. Creates an empty ring.
+	md5_ring( void );
+	/// Builds a ring of servers.
+	///
+	/// @param servers the names of the servers.
+	/// @param server_count the number of servers.
+	/// @param points_per_server the number of points for each server. Rounded up to a multiple of 4.
+	md5_ring(const char *const *servers, uint32_t server_count, uint32_t points_per_server = 160);
+
+	/// Rebuilds the ring. Labels are hashed in lock-step with 'md5_batch'.
+	///
+	/// @param servers the names of the servers.
+	/// @param server_count the number of servers.
+	/// @param points_per_server the number of points for each server. Rounded up to a multiple of 4.
+	void build(const char *const *servers, uint32_t server_count, uint32_t points_per_server = 160);
+
+	/// Returns the server a key is assigned to. Length is inferred from zero-terminator.
+	///
+	/// @param key the key.
+	///
+	/// @returns the index of the server in the array the ring was built from. MD5_RING_EMPTY if the ring has no points.
+	uint32_t lookup(const char *key) const;
+	/// Returns the server a key is assigned to. Explicit length.
+	///
+	/// @param key the key.
+	/// @param byte_count the number of bytes in the key.
+	///
+	/// @returns the index of the server in the array the ring was built from. MD5_RING_EMPTY if the ring has no points.
+	uint32_t lookup(const void *key, uint64_t byte_count) const;
+	/// Returns the server a ring position is assigned to.
+	///
+	/// @param point the position on the ring.
+	///
+	/// @returns the index of the server in the array the ring was built from. MD5_RING_EMPTY if the ring has no points.
+	uint32_t lookup_point(uint32_t point) const;
+
+	/// Returns the position on the ring of a key.
+	///
+	/// @param key the key.
+	/// @param byte_count the number of bytes in the key.
+	///
+	/// @returns the position on the ring.
+	static uint32_t point_of(const void *key, uint64_t byte_count);
+
+	/// Returns the number of points on the ring.
+	///
+	/// @returns the number of points.
+	uint32_t point_count( void ) const;
+};
+
+#endif
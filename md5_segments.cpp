@@ -0,0 +1,223 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include "md5_parallel.h"
+#include "md5_segments.h"
+#include "md5_io.h"
+
+typedef uint8_t  u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+static constexpr u64  READ_BYTESIZE   = 64 << 20; // The number of bytes read from a file at a time, rounded down to whole segments.
+static constexpr char SEGMENTS_MAGIC[8] = { 'M', 'D', '5', 'S', 'E', 'G', 'S', '1' };
+
+/// Digests consecutive segments while also ingesting them into the digest of the whole object, which runs on its own thread.
+///
+/// @param data the segments.
+/// @param byte_count the number of bytes in the segments.
+/// @param segment_size the number of bytes in each segment.
+/// @param out the destination of the digest of each segment.
+/// @param whole the digest of the whole object so far.
+/// @param thread_count the number of threads to use for the segments. Zero uses the number of hardware threads.
+static void digest_segments(const void *data, u64 byte_count, u64 segment_size, md5::sum *out, md5 &whole, u32 thread_count)
+{
+	std::thread sequential([&]() { whole.ingest(data, byte_count); });
+	md5_parts(data, byte_count, segment_size, out, thread_count);
+	sequential.join();
+}
+
+md5_segments::md5_segments( void ) : m_segments(1, md5().digest()), m_sum(md5().digest()), m_segment_size(MD5_SEGMENT_SIZE), m_byte_count(0)
+{}
+
+md5_segments::md5_segments(const void *object, u64 byte_count, u64 segment_size, u32 thread_count) : m_segments(), m_sum(), m_segment_size(segment_size < 1 ? 1 : segment_size), m_byte_count(byte_count)
+{
+	m_segments.resize(static_cast<size_t>(md5_part_count(byte_count, m_segment_size)));
+	md5 whole;
+	digest_segments(object, byte_count, m_segment_size, m_segments.data(), whole, thread_count);
+	m_sum = whole.digest();
+}
+
+bool md5_segments::from_file(const char *path, u64 segment_size, u32 thread_count)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file) {
+		return false;
+	}
+	segment_size = segment_size < 1 ? 1 : segment_size;
+	const std::streamoff end = file.tellg();
+	if (end < 0) {
+		return false;
+	}
+	const u64 byte_count = u64(end);
+	std::vector<md5::sum> segments;
+	if (md5_part_count(byte_count, segment_size) > u64(segments.max_size())) {
+		return false; // Not a regular file, or too many segments to store.
+	}
+	file.seekg(0);
+
+	segments.resize(static_cast<size_t>(md5_part_count(byte_count, segment_size)));
+	const u64 read_segments = READ_BYTESIZE / segment_size > 0 ? READ_BYTESIZE / segment_size : 1;
+	std::vector<char> buffer(static_cast<size_t>((byte_count < read_segments * segment_size) ? byte_count : read_segments * segment_size));
+	md5 whole;
+	for (u64 offset = 0; offset < byte_count;) {
+		const u64 read_size = (byte_count - offset) < buffer.size() ? (byte_count - offset) : buffer.size();
+		if (!file.read(buffer.data(), std::streamsize(read_size))) {
+			return false;
+		}
+		digest_segments(buffer.data(), read_size, segment_size, segments.data() + offset / segment_size, whole, thread_count);
+		offset += read_size;
+	}
+	if (byte_count == 0) {
+		segments[0] = whole.digest();
+	}
+
+	m_segments.swap(segments);
+	m_sum = whole.digest();
+	m_segment_size = segment_size;
+	m_byte_count = byte_count;
+	return true;
+}
+
+bool md5_segments::cover(u64 offset, u64 byte_count, u64 &cover_offset, u64 &cover_size) const
+{
+	if (offset > m_byte_count || byte_count > m_byte_count - offset) {
+		return false;
+	}
+	const u64 first = offset / m_segment_size;
+	const u64 end = byte_count > 0 ? (offset + byte_count + m_segment_size - 1) / m_segment_size : first;
+	cover_offset = first * m_segment_size;
+	cover_size = (end * m_segment_size < m_byte_count ? end * m_segment_size : m_byte_count) - cover_offset;
+	return true;
+}
+
+bool md5_segments::verify(const void *data, u64 cover_offset, u64 cover_size) const
+{
+	const u8 *bytes = reinterpret_cast<const u8*>(data);
+	if (cover_offset % m_segment_size != 0 || cover_offset > m_byte_count || cover_size > m_byte_count - cover_offset) {
+		return false;
+	}
+	if (cover_size % m_segment_size != 0 && cover_offset + cover_size != m_byte_count) { // Only the last segment may be partial.
+		return false;
+	}
+
+	const u64 first = cover_offset / m_segment_size;
+	const u64 count = (cover_size + m_segment_size - 1) / m_segment_size;
+	const void *segments[MD5_LANES];
+	u64 sizes[MD5_LANES];
+	md5::sum sums[MD5_LANES];
+	for (u64 i = 0; i < count; i += MD5_LANES) {
+		const u32 n = u32((count - i) < MD5_LANES ? (count - i) : MD5_LANES);
+		for (u32 j = 0; j < n; ++j) {
+			const u64 offset = (i + j) * m_segment_size;
+			segments[j] = bytes + offset;
+			sizes[j] = (cover_size - offset) < m_segment_size ? (cover_size - offset) : m_segment_size;
+		}
+		md5_batch(segments, sizes, sums, n);
+		for (u32 j = 0; j < n; ++j) {
+			if (!(sums[j] == m_segments[first + i + j])) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool md5_segments::verify_file(const char *path, u64 offset, u64 byte_count) const
+{
+	u64 cover_offset, cover_size;
+	if (!cover(offset, byte_count, cover_offset, cover_size)) {
+		return false;
+	}
+	std::ifstream file(path, std::ios::binary);
+	if (!file || !file.seekg(std::streamoff(cover_offset))) {
+		return false;
+	}
+	std::vector<char> buffer(static_cast<size_t>(cover_size));
+	if (cover_size > 0 && !file.read(buffer.data(), std::streamsize(cover_size))) {
+		return false;
+	}
+	return verify(buffer.data(), cover_offset, cover_size);
+}
+
+const md5::sum &md5_segments::digest( void ) const
+{
+	return m_sum;
+}
+
+u64 md5_segments::segment_count( void ) const
+{
+	return u64(m_segments.size());
+}
+
+const md5::sum *md5_segments::segments( void ) const
+{
+	return m_segments.data();
+}
+
+u64 md5_segments::segment_size( void ) const
+{
+	return m_segment_size;
+}
+
+u64 md5_segments::byte_count( void ) const
+{
+	return m_byte_count;
+}
+
+bool md5_segments::save(const char *path) const
+{
+	std::ofstream file(path, std::ios::binary);
+	if (
+		!file.write(SEGMENTS_MAGIC, sizeof(SEGMENTS_MAGIC)) ||
+		!write_le<u64>(file, m_segment_size) ||
+		!write_le<u64>(file, m_byte_count) ||
+		!file.write(reinterpret_cast<const char*>(static_cast<const u8*>(m_sum)), DIGEST_BYTESIZE)
+	) {
+		return false;
+	}
+	for (const md5::sum &segment : m_segments) {
+		if (!file.write(reinterpret_cast<const char*>(static_cast<const u8*>(segment)), DIGEST_BYTESIZE)) {
+			return false;
+		}
+	}
+	return bool(file.flush());
+}
+
+bool md5_segments::load(const char *path)
+{
+	std::ifstream file(path, std::ios::binary);
+	char magic[sizeof(SEGMENTS_MAGIC)];
+	u64 segment_size, byte_count;
+	md5::sum sum;
+	if (
+		!file.read(magic, sizeof(magic)) || memcmp(magic, SEGMENTS_MAGIC, sizeof(magic)) != 0 ||
+		!read_le<u64>(file, segment_size) || segment_size < 1 ||
+		!read_le<u64>(file, byte_count) ||
+		!file.read(reinterpret_cast<char*>(static_cast<u8*>(sum)), DIGEST_BYTESIZE)
+	) {
+		return false;
+	}
+	std::vector<md5::sum> segments;
+	for (u64 i = 0; i < md5_part_count(byte_count, segment_size); ++i) { // Grown while reading, so that a corrupt size does not allocate before failing.
+		segments.push_back(md5::sum());
+		if (!file.read(reinterpret_cast<char*>(static_cast<u8*>(segments.back())), DIGEST_BYTESIZE)) {
+			return false;
+		}
+	}
+	m_segments.swap(segments);
+	m_sum = sum;
+	m_segment_size = segment_size;
+	m_byte_count = byte_count;
+	return true;
+}
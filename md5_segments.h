@@ -0,0 +1,114 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_SEGMENTS_H_INCLUDED__
+#define MD5_SEGMENTS_H_INCLUDED__
+
+#include <cstdint>
+#include <vector>
+#include "md5.h"
+
+/// The default number of bytes in each segment.
+constexpr uint64_t MD5_SEGMENT_SIZE = 4 << 20;
+
+/// A manifest of the digests of the fixed-size segments of an object, together with the digest of the whole object. Ranges of the object can be verified by only digesting the segments that cover them. Manifests can be stored in compact binary sidecar files.
+///
+/// @note The segments are digested in parallel with 'md5_parts', while the whole object is digested on a separate thread over the same bytes, so a file is only read once.
+class md5_segments
+{
+private:
+	std::vector<md5::sum> m_segments;
+	md5::sum              m_sum;
+	uint64_t              m_segment_size;
+	uint64_t              m_byte_count;
+
+public:
+	/// Default constructor. The manifest of an empty object.
+	md5_segments( void );
+	/// Computes the manifest of an object in memory.
+	///
+	/// @param object the object.
+	/// @param byte_count the number of bytes in the object.
+	/// @param segment_size the number of bytes in each segment. At least 1. The last segment may be shorter.
+	/// @param thread_count the number of threads to use. Zero uses the number of hardware threads.
+	md5_segments(const void *object, uint64_t byte_count, uint64_t segment_size = MD5_SEGMENT_SIZE, uint32_t thread_count = 0);
+
+	/// Computes the manifest of a file.
+	///
+	/// @param path the path of the file.
+	/// @param segment_size the number of bytes in each segment. At least 1. The last segment may be shorter.
+	/// @param thread_count the number of threads to use. Zero uses the number of hardware threads.
+	///
+	/// @returns a boolean indicating true if the file could be read in full, and false otherwise. The manifest is left unmodified on failure.
+	bool from_file(const char *path, uint64_t segment_size = MD5_SEGMENT_SIZE, uint32_t thread_count = 0);
+
+	/// Returns the range of whole segments covering a range of the object.
+	///
+	/// @param offset the offset of the first byte of the range.
+	/// @param byte_count the number of bytes in the range.
+	/// @param cover_offset the destination offset of the first byte of the covering segments.
+	/// @param cover_size the destination number of bytes in the covering segments.
+	///
+	/// @returns a boolean indicating true if the range is within the object, and false otherwise.
+	bool cover(uint64_t offset, uint64_t byte_count, uint64_t &cover_offset, uint64_t &cover_size) const;
+
+	/// Verifies a range of whole segments against the manifest.
+	///
+	/// @param data the bytes of the segments.
+	/// @param cover_offset the offset of the first byte of the segments, as returned by 'cover'.
+	/// @param cover_size the number of bytes in the segments, as returned by 'cover'.
+	///
+	/// @returns a boolean indicating true if the range is made up of whole segments whose digests match the manifest, and false otherwise.
+	bool verify(const void *data, uint64_t cover_offset, uint64_t cover_size) const;
+	/// Verifies a range of a file against the manifest. Only the segments covering the range are read and digested.
+	///
+	/// @param path the path of the file.
+	/// @param offset the offset of the first byte of the range.
+	/// @param byte_count the number of bytes in the range.
+	///
+	/// @returns a boolean indicating true if the segments covering the range could be read and match the manifest, and false otherwise.
+	bool verify_file(const char *path, uint64_t offset, uint64_t byte_count) const;
+
+	/// Returns the digest of the whole object.
+	///
+	/// @returns the digest.
+	const md5::sum &digest( void ) const;
+	/// Returns the number of segments.
+	///
+	/// @returns the number of segments.
+	uint64_t segment_count( void ) const;
+	/// Returns the digests of the segments.
+	///
+	/// @returns the array of 'segment_count' segment digests.
+	const md5::sum *segments( void ) const;
+	/// Returns the number of bytes in each segment.
+	///
+	/// @returns the segment size.
+	uint64_t segment_size( void ) const;
+	/// Returns the number of bytes in the object.
+	///
+	/// @returns the object size.
+	uint64_t byte_count( void ) const;
+
+	/// Writes the manifest to a sidecar file. The file holds a magic number, the segment size, the object size, the digest of the object and the digests of the segments.
+	///
+	/// @param path the path of the file.
+	///
+	/// @returns a boolean indicating true if the file was written, and false otherwise.
+	bool save(const char *path) const;
+	/// Replaces the manifest with one read from a sidecar file.
+	///
+	/// @param path the path of the file.
+	///
+	/// @returns a boolean indicating true if the file contained a valid manifest, and false otherwise, in which case the manifest is left unchanged.
+	bool load(const char *path);
+};
+
+#endif
@@ -0,0 +1,114 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#include <cstring>
+#include "md5_parallel.h"
+#include "md5_tree.h"
+
+typedef uint8_t  u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+static constexpr u8 LEAF_PREFIX = 0x00;
+static constexpr u8 NODE_PREFIX = 0x01;
+
+void md5_tree::push(const md5::sum &leaf)
+{
+	// Every completed pair of equally sized subtrees is merged, which is once for each trailing zero bit of the leaf count.
+	m_stack.push_back(leaf);
+	++m_leaf_count;
+	for (u64 count = m_leaf_count; (count & 1) == 0; count >>= 1) {
+		const md5::sum right = m_stack.back();
+		m_stack.pop_back();
+		m_stack.back() = node(m_stack.back(), right);
+	}
+}
+
+md5_tree::md5_tree(u64 leaf_size, u32 thread_count) : m_stack(), m_leaf(&LEAF_PREFIX, 1), m_leaf_fill(0), m_leaf_count(0), m_leaf_size(leaf_size < 1 ? 1 : leaf_size), m_thread_count(thread_count)
+{}
+
+md5_tree::md5_tree(const void *message, u64 byte_count, u64 leaf_size, u32 thread_count) : md5_tree(leaf_size, thread_count)
+{
+	ingest(message, byte_count);
+}
+
+md5_tree &md5_tree::ingest(const void *message, u64 byte_count)
+{
+	const u8 *msg = reinterpret_cast<const u8*>(message);
+
+	// Tops up the current leaf.
+	if (m_leaf_fill > 0) {
+		const u64 size = (m_leaf_size - m_leaf_fill) < byte_count ? (m_leaf_size - m_leaf_fill) : byte_count;
+		m_leaf.ingest(msg, size);
+		m_leaf_fill += size;
+		msg += size;
+		byte_count -= size;
+		if (m_leaf_fill == m_leaf_size) {
+			push(m_leaf.digest());
+			m_leaf = md5(&LEAF_PREFIX, 1);
+			m_leaf_fill = 0;
+		}
+	}
+
+	// Whole leaves are independent of each other, and are digested in parallel.
+	const u64 leaf_count = byte_count / m_leaf_size;
+	if (leaf_count > 0) {
+		std::vector<md5::sum> leaves(static_cast<size_t>(leaf_count));
+		md5_parts(&LEAF_PREFIX, 1, msg, leaf_count * m_leaf_size, m_leaf_size, leaves.data(), m_thread_count);
+		for (size_t i = 0; i < leaves.size(); ++i) {
+			push(leaves[i]);
+		}
+		msg += leaf_count * m_leaf_size;
+		byte_count -= leaf_count * m_leaf_size;
+	}
+
+	if (byte_count > 0) {
+		m_leaf.ingest(msg, byte_count);
+		m_leaf_fill += byte_count;
+	}
+	return *this;
+}
+
+md5::sum md5_tree::digest( void ) const
+{
+	// A partial leaf, or the empty leaf of an empty message, is the rightmost leaf. The subtrees are then merged from right to left.
+	md5::sum root;
+	size_t i = m_stack.size();
+	if (m_leaf_fill > 0 || m_leaf_count == 0) {
+		root = m_leaf.digest();
+	} else {
+		root = m_stack[--i];
+	}
+	while (i > 0) {
+		root = node(m_stack[--i], root);
+	}
+	return root;
+}
+
+u64 md5_tree::leaf_size( void ) const
+{
+	return m_leaf_size;
+}
+
+md5::sum md5_tree::leaf(const void *data, u64 byte_count)
+{
+	md5 ctx(&LEAF_PREFIX, 1);
+	ctx.ingest(data, byte_count);
+	return ctx.digest();
+}
+
+md5::sum md5_tree::node(const md5::sum &left, const md5::sum &right)
+{
+	u8 message[1 + sizeof(md5::sum) * 2];
+	message[0] = NODE_PREFIX;
+	memcpy(message + 1, static_cast<const u8*>(left), sizeof(md5::sum));
+	memcpy(message + 1 + sizeof(md5::sum), static_cast<const u8*>(right), sizeof(md5::sum));
+	return md5(message, sizeof(message)).digest();
+}
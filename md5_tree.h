@@ -0,0 +1,88 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_TREE_H_INCLUDED__
+#define MD5_TREE_H_INCLUDED__
+
+#include <cstdint>
+#include <vector>
+#include "md5.h"
+
+/// The default number of bytes in each leaf of a tree digest.
+constexpr uint64_t MD5_TREE_LEAF_SIZE = 1 << 20;
+
+/// Computes a Merkle tree digest of a message, which unlike a standard MD5 digest can be computed on several threads. The message is split into fixed-size leaves, and each leaf is digested as 0x00 followed by the leaf, while each node is digested as 0x01 followed by the digests of its left and right children. The left subtree of every node holds the largest power of two of leaves that is less than the number of leaves under the node, and the digest of a single leaf is the digest of the tree.
+///
+/// @note Tree digests are not MD5 digests of the message, and are only comparable to other tree digests of the same leaf size. The digest does not depend on the number of threads or on how the message is split into calls to 'ingest'.
+class md5_tree
+{
+private:
+	std::vector<md5::sum> m_stack;        // The roots of the complete subtrees so far, from left to right.
+	md5                   m_leaf;         // The digest of the current leaf so far, including the leaf prefix.
+	uint64_t              m_leaf_fill;    // The number of message bytes in the current leaf.
+	uint64_t              m_leaf_count;   // The number of completed leaves.
+	uint64_t              m_leaf_size;
+	uint32_t              m_thread_count;
+
+private:
+	/// Adds the digest of a completed leaf, merging the subtrees it completes.
+	///
+	/// @param leaf the digest of the leaf.
+	void push(const md5::sum &leaf);
+
+public:
+	/// Creates an empty tree.
+	///
+	/// @param leaf_size the number of bytes in each leaf. At least 1.
+	/// @param thread_count the number of threads to digest whole leaves with. Zero uses the number of hardware threads.
+	explicit md5_tree(uint64_t leaf_size = MD5_TREE_LEAF_SIZE, uint32_t thread_count = 0);
+	/// Creates a tree from a message. Explicit length.
+	///
+	/// @param message the message.
+	/// @param byte_count the number of bytes in the message.
+	/// @param leaf_size the number of bytes in each leaf. At least 1.
+	/// @param thread_count the number of threads to digest whole leaves with. Zero uses the number of hardware threads.
+	md5_tree(const void *message, uint64_t byte_count, uint64_t leaf_size = MD5_TREE_LEAF_SIZE, uint32_t thread_count = 0);
+
+	/// Ingests the next bytes of the message. Whole leaves are digested on several threads and in lock-step with 'md5_batch', so large calls are faster than small ones.
+	///
+	/// @param message the bytes.
+	/// @param byte_count the number of bytes.
+	///
+	/// @returns a reference to the tree.
+	md5_tree &ingest(const void *message, uint64_t byte_count);
+
+	/// Returns the tree digest of the message ingested so far. Bytes can still be ingested afterwards.
+	///
+	/// @returns the tree digest.
+	md5::sum digest( void ) const;
+
+	/// Returns the number of bytes in each leaf.
+	///
+	/// @returns the leaf size.
+	uint64_t leaf_size( void ) const;
+
+	/// Computes the digest of a leaf.
+	///
+	/// @param data the bytes of the leaf.
+	/// @param byte_count the number of bytes in the leaf.
+	///
+	/// @returns the digest of 0x00 followed by the leaf.
+	static md5::sum leaf(const void *data, uint64_t byte_count);
+	/// Computes the digest of a node.
+	///
+	/// @param left the digest of the left child.
+	/// @param right the digest of the right child.
+	///
+	/// @returns the digest of 0x01 followed by the digests of the children.
+	static md5::sum node(const md5::sum &left, const md5::sum &right);
+};
+
+#endif
@@ -0,0 +1,77 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#include <cstring>
+#include "md5.h"
+#include "md5_uuid.h"
+
+typedef uint8_t  u8;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+static constexpr u32 BATCH_SIZE = MD5_LANES * 8; // The number of names hashed per call to 'md5_batch'.
+
+/// Converts a digest into a version 3 UUID by setting the version and variant bits.
+///
+/// @param sum the digest of the namespace and name.
+/// @param out the destination binary UUID.
+static void to_uuid(const md5::sum &sum, u8 *out)
+{
+	memcpy(out, static_cast<const u8*>(sum), UUID_BYTESIZE);
+	out[6] = (out[6] & 0x0f) | 0x30; // Version 3.
+	out[8] = (out[8] & 0x3f) | 0x80; // RFC 4122 variant.
+}
+
+/// Prints a binary UUID in canonical text form.
+///
+/// @param uuid the binary UUID.
+/// @param out the destination string.
+///
+/// @returns the pointer to the location in the string at which printing stopped.
+static char *sprint_uuid(const u8 *uuid, char *out)
+{
+	static constexpr char DIGITS[] = "0123456789abcdef";
+	for (u32 i = 0; i < UUID_BYTESIZE; ++i) {
+		if (i == 4 || i == 6 || i == 8 || i == 10) {
+			*out++ = '-';
+		}
+		out[0] = DIGITS[uuid[i] >> 4];
+		out[1] = DIGITS[uuid[i] & 15];
+		out += 2;
+	}
+	return out;
+}
+
+void uuid_v3_batch(const u8 *namespace_id, const void *const *names, const u64 *name_sizes, u64 count, u8 *out)
+{
+	md5::sum sums[BATCH_SIZE];
+	for (u64 i = 0; i < count; i += BATCH_SIZE) {
+		const u64 n = (count - i) < BATCH_SIZE ? (count - i) : BATCH_SIZE;
+		md5_batch_prefixed(namespace_id, UUID_BYTESIZE, names + i, name_sizes + i, sums, n);
+		for (u64 j = 0; j < n; ++j, out += UUID_BYTESIZE) {
+			to_uuid(sums[j], out);
+		}
+	}
+}
+
+char *uuid_v3_batch_text(const u8 *namespace_id, const void *const *names, const u64 *name_sizes, u64 count, char *out)
+{
+	md5::sum sums[BATCH_SIZE];
+	for (u64 i = 0; i < count; i += BATCH_SIZE) {
+		const u64 n = (count - i) < BATCH_SIZE ? (count - i) : BATCH_SIZE;
+		md5_batch_prefixed(namespace_id, UUID_BYTESIZE, names + i, name_sizes + i, sums, n);
+		for (u64 j = 0; j < n; ++j) {
+			u8 uuid[UUID_BYTESIZE];
+			to_uuid(sums[j], uuid);
+			out = sprint_uuid(uuid, out);
+		}
+	}
+	return out;
+}
@@ -0,0 +1,50 @@
+/// @file
+/// @author github.com/SirJonthe
+/// @date 2019, 2021, 2022
+/// @copyright Public domain. Derived from the RSA Data Security, Inc. MD5 Message-Digest Algorithm.
+/// @license BSD-3-Clause
+
+// THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+// IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+
+#ifndef MD5_UUID_H_INCLUDED__
+#define MD5_UUID_H_INCLUDED__
+
+#include <cstdint>
+
+/// The number of bytes in a binary UUID.
+constexpr uint32_t UUID_BYTESIZE = 16;
+/// The number of characters in a canonical text UUID, excluding any zero-terminator.
+constexpr uint32_t UUID_TEXT_SIZE = 36;
+
+/// The predefined namespace for fully-qualified domain names (RFC 4122, appendix C).
+constexpr uint8_t UUID_NAMESPACE_DNS[UUID_BYTESIZE]  = { 0x6b, 0xa7, 0xb8, 0x10, 0x9d, 0xad, 0x11, 0xd1, 0x80, 0xb4, 0x00, 0xc0, 0x4f, 0xd4, 0x30, 0xc8 };
+/// The predefined namespace for URLs (RFC 4122, appendix C).
+constexpr uint8_t UUID_NAMESPACE_URL[UUID_BYTESIZE]  = { 0x6b, 0xa7, 0xb8, 0x11, 0x9d, 0xad, 0x11, 0xd1, 0x80, 0xb4, 0x00, 0xc0, 0x4f, 0xd4, 0x30, 0xc8 };
+/// The predefined namespace for ISO OIDs (RFC 4122, appendix C).
+constexpr uint8_t UUID_NAMESPACE_OID[UUID_BYTESIZE]  = { 0x6b, 0xa7, 0xb8, 0x12, 0x9d, 0xad, 0x11, 0xd1, 0x80, 0xb4, 0x00, 0xc0, 0x4f, 0xd4, 0x30, 0xc8 };
+/// The predefined namespace for X.500 DNs (RFC 4122, appendix C).
+constexpr uint8_t UUID_NAMESPACE_X500[UUID_BYTESIZE] = { 0x6b, 0xa7, 0xb8, 0x14, 0x9d, 0xad, 0x11, 0xd1, 0x80, 0xb4, 0x00, 0xc0, 0x4f, 0xd4, 0x30, 0xc8 };
+
+/// Generates name-based version 3 UUIDs (RFC 4122) for several names in the same namespace. The names are hashed in lock-step with 'md5_batch'. Does not allocate memory.
+///
+/// @param namespace_id the namespace UUID in binary (network byte order) form.
+/// @param names the names.
+/// @param name_sizes the number of bytes in each name.
+/// @param count the number of names.
+/// @param out the destination of the binary UUIDs. Must fit 'count' * UUID_BYTESIZE bytes.
+void uuid_v3_batch(const uint8_t *namespace_id, const void *const *names, const uint64_t *name_sizes, uint64_t count, uint8_t *out);
+
+/// Generates name-based version 3 UUIDs (RFC 4122) for several names in the same namespace, in canonical text form ('xxxxxxxx-xxxx-3xxx-yxxx-xxxxxxxxxxxx'). The names are hashed in lock-step with 'md5_batch'. Does not allocate memory.
+///
+/// @param namespace_id the namespace UUID in binary (network byte order) form.
+/// @param names the names.
+/// @param name_sizes the number of bytes in each name.
+/// @param count the number of names.
+/// @param out the destination of the text UUIDs, printed back to back without separators or zero-terminators. Must fit 'count' * UUID_TEXT_SIZE characters.
+///
+/// @returns the pointer to the location in 'out' at which printing stopped.
+char *uuid_v3_batch_text(const uint8_t *namespace_id, const void *const *names, const uint64_t *name_sizes, uint64_t count, char *out);
+
+#endif